@@ -0,0 +1,391 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+// Throughput benchmark for the utfcpp helpers.
+//
+// usage: utfcpp_bench [--json] [--filter=<substring>] [--size=<bytes>] [--min-time=<seconds>]
+//
+// Every benchmark runs over every generated corpus; one record is printed per pair, as CSV
+// (default) or as JSON lines. Throughput is measured against the size of the input in bytes.
+
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <span>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "utfcpp/utfcpp.hpp"
+
+
+namespace {
+
+
+/***
+ * Corpora
+ */
+struct Corpus {
+    std::string name;
+    std::u8string utf8;
+    std::u16string utf16;
+    std::u32string utf32;
+    // Lossy: code points above 0xff are replaced
+    std::string latin1;
+    // utf16 as UTF-16BE bytes
+    std::vector<std::byte> utf16be;
+};
+
+
+// Small deterministic generator; corpora must be identical between runs to be comparable.
+class Random {
+public:
+    explicit Random(uint64_t seed) noexcept : state{seed} {}
+    uint32_t Next() noexcept {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<uint32_t>(state >> 33);
+    }
+    uint32_t Below(uint32_t n) noexcept { return Next() % n; }
+    char32_t Between(char32_t first, char32_t last) noexcept { return first + Below(last - first + 1); }
+
+private:
+    uint64_t state;
+};
+
+
+// Words of code points from pick, separated by spaces and the occasional punctuation, until the
+// utf-8 form reaches size bytes.
+template <typename Pick>
+std::u32string GenerateText(size_t size, uint64_t seed, Pick pick) {
+    Random random{seed};
+    std::u32string text{};
+    size_t utf8_size = 0;
+    while (utf8_size < size) {
+        const uint32_t word_length = 1 + random.Below(9);
+        for (uint32_t i = 0; i < word_length; ++i) {
+            const char32_t code_point = pick(random);
+            text.push_back(code_point);
+            utf8_size += utfcpp::EncodedLengthUTF8(code_point);
+        }
+        text.push_back(random.Below(8) ? U' ' : U".,;!?\n"[random.Below(6)]);
+        ++utf8_size;
+    }
+    return text;
+}
+
+
+std::vector<std::byte> BigEndianBytes(std::u16string_view utf16) {
+    std::vector<std::byte> bytes{};
+    for (char16_t unit : utf16) {
+        bytes.push_back(static_cast<std::byte>(unit >> 8));
+        bytes.push_back(static_cast<std::byte>(unit & 0xff));
+    }
+    return bytes;
+}
+
+
+Corpus MakeCorpus(std::string name, std::u32string text) {
+    std::string latin1 = utfcpp::utf32_to_latin1(text);
+    std::u16string utf16 = utfcpp::utf32_to_16(text);
+    std::vector<std::byte> utf16be = BigEndianBytes(utf16);
+    Corpus corpus{std::move(name), utfcpp::utf32_to_8(text), std::move(utf16), std::move(text), std::move(latin1),
+                  std::move(utf16be)};
+    return corpus;
+}
+
+
+// Roughly one in every period code units is replaced by something invalid in that encoding.
+Corpus MakeInvalidCorpus(std::string name, std::u32string text, uint32_t period) {
+    Corpus corpus = MakeCorpus(std::move(name), std::move(text));
+    Random random{0xbad};
+    const char8_t bad8[] = {0x80, 0xbf, 0xc0, 0xc1, 0xf5, 0xff};
+    for (char8_t& ch : corpus.utf8)   { if (!random.Below(period)) { ch = bad8[random.Below(std::size(bad8))]; } }
+    const char16_t bad16[] = {0xd800, 0xdbff, 0xdc00, 0xdfff};
+    for (char16_t& ch : corpus.utf16) { if (!random.Below(period)) { ch = bad16[random.Below(std::size(bad16))]; } }
+    corpus.utf16be = BigEndianBytes(corpus.utf16);
+    const char32_t bad32[] = {0xd800, 0xdfff, 0x110000, 0xffffffff};
+    for (char32_t& ch : corpus.utf32) { if (!random.Below(period)) { ch = bad32[random.Below(std::size(bad32))]; } }
+    return corpus;
+}
+
+
+std::vector<Corpus> MakeCorpora(size_t size) {
+    auto ascii    = [](Random& r) { return r.Between(U'a', U'z'); };
+    auto latin1   = [](Random& r) { return r.Below(3) ? r.Between(U'a', U'z') : r.Between(0xc0, 0xff); };
+    auto cyrillic = [](Random& r) { return r.Between(0x0430, 0x044f); };
+    auto cjk      = [](Random& r) { return r.Between(0x4e00, 0x9fff); };
+    auto emoji    = [](Random& r) { return r.Below(4) ? r.Between(0x1f600, 0x1f64f) : r.Between(0x1f300, 0x1f5ff); };
+    auto mixed    = [=](Random& r) {
+        switch (r.Below(5)) {
+            case 0:  return ascii(r);
+            case 1:  return latin1(r);
+            case 2:  return cyrillic(r);
+            case 3:  return cjk(r);
+            default: return emoji(r);
+        }
+    };
+
+    std::vector<Corpus> corpora{};
+    corpora.push_back(MakeCorpus("ascii",    GenerateText(size, 1, ascii)));
+    corpora.push_back(MakeCorpus("latin1",   GenerateText(size, 2, latin1)));
+    corpora.push_back(MakeCorpus("cyrillic", GenerateText(size, 3, cyrillic)));
+    corpora.push_back(MakeCorpus("cjk",      GenerateText(size, 4, cjk)));
+    corpora.push_back(MakeCorpus("emoji",    GenerateText(size, 5, emoji)));
+    corpora.push_back(MakeCorpus("mixed",    GenerateText(size, 6, mixed)));
+    corpora.push_back(MakeInvalidCorpus("invalid", GenerateText(size, 7, mixed), 64));
+    return corpora;
+}
+
+
+/***
+ * Benchmarks
+ */
+template <typename T>
+const std::basic_string<T>& Input(const Corpus& corpus) {
+    if constexpr (std::is_same_v<T, char8_t>)       { return corpus.utf8; }
+    else if constexpr (std::is_same_v<T, char16_t>) { return corpus.utf16; }
+    else if constexpr (std::is_same_v<T, char32_t>) { return corpus.utf32; }
+    else                                            { return corpus.latin1; }
+}
+
+
+struct Benchmark {
+    std::string name;
+    // Input size in bytes
+    std::function<size_t(const Corpus&)> bytes;
+    // Runs once; the result feeds a checksum so that the work cannot be optimised away
+    std::function<size_t(const Corpus&)> run;
+};
+
+
+template <typename T, typename F>
+Benchmark MakeBenchmark(std::string name, F f) {
+    return Benchmark{
+        std::move(name),
+        [](const Corpus& corpus) { return Input<T>(corpus).size() * sizeof(T); },
+        [f](const Corpus& corpus) { return f(std::basic_string_view<T>{Input<T>(corpus)}); }
+    };
+}
+
+
+// Benchmarks over the UTF-16BE bytes of the corpus
+template <typename F>
+Benchmark MakeBigEndianBenchmark(std::string name, F f) {
+    return Benchmark{
+        std::move(name),
+        [](const Corpus& corpus) { return corpus.utf16be.size(); },
+        [f](const Corpus& corpus) { return f(std::span<const std::byte>{corpus.utf16be}); }
+    };
+}
+
+
+// Raw iteration over a view; the checksum keeps the decoded code points alive.
+template <template<typename> typename Iter_t, typename T>
+size_t Iterate(std::basic_string_view<T> sv) {
+    size_t checksum = 0;
+    for (char32_t code_point : utfcpp::UTFView<T, Iter_t>{sv}) { checksum += code_point; }
+    return checksum;
+}
+
+
+std::vector<Benchmark> MakeBenchmarks() {
+    using namespace utfcpp;
+    std::vector<Benchmark> benchmarks{};
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("FindInvalid/utf8",   [](auto sv) { return FindInvalid(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("FindInvalid/utf16", [](auto sv) { return FindInvalid(sv); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("FindInvalid/utf32", [](auto sv) { return FindInvalid(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("IsValid/utf8",   [](auto sv) { return size_t{IsValid(sv)}; }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("IsValid/utf16", [](auto sv) { return size_t{IsValid(sv)}; }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("IsValid/utf32", [](auto sv) { return size_t{IsValid(sv)}; }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("CountCodePoints/utf8",   [](auto sv) { return CountCodePoints(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("CountCodePoints/utf16", [](auto sv) { return CountCodePoints(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("CodePointOffset/utf8",
+        [](auto sv) { return CodePointOffset(sv, sv.size() / 2); }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("DecodeBlock/utf8", [](auto sv) {
+        std::array<char32_t, 4096> block{};
+        size_t produced = 0;
+        while (!sv.empty()) {
+            const TranscodeResult result = DecodeBlock(sv, std::span<char32_t>{block});
+            produced += result.produced;
+            sv.remove_prefix(result.consumed);
+        }
+        return produced;
+    }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFConvertInto/utf8_to_16", [](auto sv) {
+        std::array<char16_t, 4096> buffer{};
+        size_t produced = 0;
+        while (!sv.empty()) {
+            const TranscodeResult result = UTFConvertInto<char8_t, char16_t>(sv, std::span{buffer});
+            produced += result.produced;
+            sv.remove_prefix(result.consumed);
+        }
+        return produced;
+    }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFConvertAppend/utf8_to_16/vector", [](auto sv) {
+        std::vector<char16_t> sink{};
+        UTFConvertAppend<char8_t, char16_t>(sv, sink);
+        return sink.size();
+    }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("CodePointAppender/utf8_to_16/vector", [](auto sv) {
+        std::vector<char16_t> sink{};
+        std::ranges::copy(UTFView{sv}, CodePointAppender(sink));
+        return sink.size();
+    }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("utf8_to_8",    [](auto sv) { return utf8_to_8(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("utf8_to_16",   [](auto sv) { return utf8_to_16(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("utf8_to_32",   [](auto sv) { return utf8_to_32(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("utf16_to_8",  [](auto sv) { return utf16_to_8(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("utf16_to_16", [](auto sv) { return utf16_to_16(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("utf16_to_32", [](auto sv) { return utf16_to_32(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("utf32_to_8",  [](auto sv) { return utf32_to_8(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("utf32_to_16", [](auto sv) { return utf32_to_16(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("utf32_to_32", [](auto sv) { return utf32_to_32(sv).size(); }));
+
+    benchmarks.push_back(MakeBenchmark<char>("IsASCII/latin1",    [](auto sv) { return size_t{IsASCII(sv)}; }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("IsASCII/utf16", [](auto sv) { return size_t{IsASCII(sv)}; }));
+    benchmarks.push_back(MakeBenchmark<char>("latin1_to_8",       [](auto sv) { return latin1_to_8(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char>("latin1_to_16",      [](auto sv) { return latin1_to_16(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("utf8_to_latin1",   [](auto sv) { return utf8_to_latin1(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("utf16_to_latin1", [](auto sv) { return utf16_to_latin1(sv).size(); }));
+
+    benchmarks.push_back(MakeBigEndianBenchmark("FindInvalidEndian/utf16be",
+        [](auto bytes) { return FindInvalidEndian<char16_t, std::endian::big>(bytes); }));
+    benchmarks.push_back(MakeBigEndianBenchmark("utf16be_to_8",  [](auto bytes) { return utf16be_to_8(bytes).size(); }));
+    benchmarks.push_back(MakeBigEndianBenchmark("utf16be_to_32", [](auto bytes) { return utf16be_to_32(bytes).size(); }));
+    benchmarks.push_back(MakeBigEndianBenchmark("UTFView/utf16be", [](auto bytes) {
+        size_t checksum = 0;
+        for (char32_t code_point : utf16be_view{bytes}) { checksum += code_point; }
+        return checksum;
+    }));
+
+    // Bounded by DETECT_SAMPLE_SIZE whatever the input size; the time is the figure to watch
+    benchmarks.push_back(MakeBenchmark<char8_t>("DetectEncoding/utf8",
+        [](auto sv) { return static_cast<size_t>(DetectEncoding(std::as_bytes(std::span{sv})).encoding); }));
+    benchmarks.push_back(MakeBigEndianBenchmark("DetectEncoding/utf16be",
+        [](auto bytes) { return static_cast<size_t>(DetectEncoding(bytes).encoding); }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("utf8_to_16_parallel",
+        [](auto sv) { return UTFConvertToParallel<char8_t, char16_t>(sv).size(); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("utf16_to_8_parallel",
+        [](auto sv) { return UTFConvertToParallel<char16_t, char8_t>(sv).size(); }));
+
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFView/utf8", [](auto sv) { return Iterate<UTFInputIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("UTFView/utf16", [](auto sv) { return Iterate<UTFInputIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("UTFView/utf32", [](auto sv) { return Iterate<UTFInputIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFView/utf8/lean", [](auto sv) { return Iterate<UTFLeanIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("UTFView/utf16/lean", [](auto sv) { return Iterate<UTFLeanIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("UTFView/utf32/lean", [](auto sv) { return Iterate<UTFLeanIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFView/utf8/bidirectional", [](auto sv) { return Iterate<UTFBidirectionalIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("UTFView/utf16/bidirectional", [](auto sv) { return Iterate<UTFBidirectionalIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("UTFView/utf32/bidirectional", [](auto sv) { return Iterate<UTFBidirectionalIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFView/utf8/unchecked", [](auto sv) { return Iterate<UncheckedUTFIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char16_t>("UTFView/utf16/unchecked", [](auto sv) { return Iterate<UncheckedUTFIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char32_t>("UTFView/utf32/unchecked", [](auto sv) { return Iterate<UncheckedUTFIterator>(sv); }));
+    benchmarks.push_back(MakeBenchmark<char8_t>("UTFView/utf8/dfa", [](auto sv) { return Iterate<UTFDFAIterator>(sv); }));
+
+    return benchmarks;
+}
+
+
+/***
+ * Driver
+ */
+struct Options {
+    bool json{false};
+    std::string filter{};
+    size_t size{1 << 20};
+    double min_time{0.25};
+};
+
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options{};
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+        if (arg == "--json")                    { options.json = true; }
+        else if (arg.starts_with("--filter="))  { options.filter = arg.substr(9); }
+        else if (arg.starts_with("--size="))    { options.size = std::strtoull(arg.data() + 7, nullptr, 10); }
+        else if (arg.starts_with("--min-time=")) { options.min_time = std::strtod(arg.data() + 11, nullptr); }
+        else {
+            std::fprintf(stderr, "usage: %s [--json] [--filter=<substring>] [--size=<bytes>] [--min-time=<seconds>]\n", argv[0]);
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+
+struct Measurement {
+    size_t iterations{0};
+    double seconds{0.0};  // best single iteration
+    size_t checksum{0};
+};
+
+
+Measurement Measure(const Benchmark& benchmark, const Corpus& corpus, double min_time) {
+    using clock = std::chrono::steady_clock;
+    Measurement measurement{};
+    measurement.checksum = benchmark.run(corpus);  // warm up caches and allocator
+    double total = 0.0;
+    while (total < min_time || measurement.iterations < 3) {
+        const auto start = clock::now();
+        measurement.checksum += benchmark.run(corpus);
+        const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+        total += elapsed;
+        if (measurement.iterations == 0 || elapsed < measurement.seconds) { measurement.seconds = elapsed; }
+        ++measurement.iterations;
+    }
+    return measurement;
+}
+
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    const Options options = ParseOptions(argc, argv);
+    const std::vector<Corpus> corpora = MakeCorpora(options.size);
+    const std::vector<Benchmark> benchmarks = MakeBenchmarks();
+
+    volatile size_t sink = 0;
+    if (!options.json) { std::printf("benchmark,corpus,bytes,iterations,seconds,gb_per_s\n"); }
+    for (const Benchmark& benchmark : benchmarks) {
+        if (benchmark.name.find(options.filter) == std::string::npos) { continue; }
+        for (const Corpus& corpus : corpora) {
+            const size_t bytes = benchmark.bytes(corpus);
+            const Measurement m = Measure(benchmark, corpus, options.min_time);
+            sink = sink + m.checksum;
+            const double gb_per_s = m.seconds > 0.0 ? static_cast<double>(bytes) / m.seconds / 1e9 : 0.0;
+            const char* format = options.json ?
+                "{\"benchmark\":\"%s\",\"corpus\":\"%s\",\"bytes\":%zu,\"iterations\":%zu,\"seconds\":%.9f,\"gb_per_s\":%.4f}\n" :
+                "%s,%s,%zu,%zu,%.9f,%.4f\n";
+            std::printf(format, benchmark.name.c_str(), corpus.name.c_str(), bytes, m.iterations, m.seconds, gb_per_s);
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}
@@ -16,6 +16,7 @@
 
 
 #include <concepts>
+#include <cstddef>
 
 
 namespace utfcpp {
@@ -25,6 +26,26 @@ template <typename T> concept IsUTF_c = std::same_as<T, char8_t>  ||
                                         std::same_as<T, char16_t> ||
                                         std::same_as<T, char32_t>;
 
+// Unicode code units, or the bytes of single byte encodings such as Latin-1
+template <typename T> concept IsCodeUnit_c = IsUTF_c<T> || std::same_as<T, char>;
+
+// Code units wider than a byte, stored in some byte order
+template <typename T> concept IsWideUTF_c = std::same_as<T, char16_t> || std::same_as<T, char32_t>;
+
+
+// Destinations for code units of T: anything that appends a run of them, like std::basic_string, inserts
+// a range at its end, like std::vector, or at least takes them one at a time with push_back.
+template <typename S, typename T> concept IsAppendSink_c = requires(S& sink, const T* data, size_t n) {
+    sink.append(data, n);
+};
+template <typename S, typename T> concept IsInsertSink_c = requires(S& sink, const T* data) {
+    sink.insert(sink.end(), data, data);
+};
+template <typename S, typename T> concept IsPushBackSink_c = requires(S& sink, T unit) { sink.push_back(unit); };
+template <typename S, typename T> concept IsCodeUnitSink_c = IsAppendSink_c<S, T> ||
+                                                             IsInsertSink_c<S, T> ||
+                                                             IsPushBackSink_c<S, T>;
+
 
 
 
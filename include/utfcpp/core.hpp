@@ -58,7 +58,7 @@ constexpr char32_t REPLACEMENT_CHARACTER {U'\ufffd'};
  * codepoint tests
  */
 constexpr bool IsTrailUTF8(char8_t ch) noexcept {
-    return ch > TRAIL_UTF8_MIN;
+    return (ch & 0xc0) == 0x80;
 }
 
 
@@ -15,8 +15,11 @@
 #pragma once
 
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -33,6 +36,15 @@ struct DecodeData {
 };
 
 
+// Outcome of converting many code points: code units read, code units (or code points) written, and
+// the error that stopped conversion or, for calls that replace invalid input, the first one replaced.
+struct TranscodeResult {
+    size_t consumed{0};
+    size_t produced{0};
+    UTF_ERROR error_code{UTF_ERROR::OK};
+};
+
+
 constexpr DecodeData DecodeUTF8(std::u8string_view utf8str) noexcept {
     if (utf8str.empty()) { return DecodeData{.error_code=UTF_ERROR::INCOMPLETE_SEQUENCE}; }
 
@@ -53,32 +65,14 @@ constexpr DecodeData DecodeUTF8(std::u8string_view utf8str) noexcept {
     // 1) utf8str does not contain the required number of bytes, or
     // 2) some of the expected trail bytes have invalid value
     if (length > utf8str.length()) { return DecodeData{.consumed=1, .error_code=UTF_ERROR::INCOMPLETE_SEQUENCE}; }
-    for (char8_t cp : utf8str | std::views::take(length) | std::views::drop(1)) {
+    // The lead byte keeps its low 7 - length bits and every trail byte adds 6. The trail bytes are read
+    // through substr, so that the compiler sees the reads stay within utf8str.
+    char32_t code_point = static_cast<char32_t>(lead) & (0x7fu >> length);
+    for (char8_t cp : utf8str.substr(1, length - 1)) {
         if (!IsTrailUTF8(cp)) {
             return DecodeData{.consumed=1, .error_code=UTF_ERROR::INCOMPLETE_SEQUENCE};
         }
-    }
-
-    // initialize to common value used in all initializations.
-    char32_t code_point = static_cast<char32_t>(lead);
-    switch (length) {
-    case 2:
-        code_point = ((code_point << 6) & 0x7ff) +
-                     (static_cast<char32_t>(utf8str[1]) & 0x3f);
-        break;
-    case 3:
-        code_point = ((code_point << 12) & 0xffff) +
-                     ((static_cast<char32_t>(utf8str[1]) << 6) & 0xfff) +
-                     (static_cast<char32_t>(utf8str[2]) & 0x3f);
-        break;
-    case 4:
-        code_point = ((code_point << 18) & 0x1fffff) +
-                     ((static_cast<char32_t>(utf8str[1]) << 12) & 0x3ffff) +
-                     ((static_cast<char32_t>(utf8str[2]) << 6) & 0xfff) +
-                     (static_cast<char32_t>(utf8str[3]) & 0x3f);
-        break;
-    default:
-        return DecodeData{.consumed=1, .error_code=UTF_ERROR::INVALID_LEAD};
+        code_point = (code_point << 6) + (static_cast<char32_t>(cp) & 0x3f);
     }
 
     // Decoding succeeded. Now, security checks...
@@ -97,29 +91,148 @@ constexpr DecodeData DecodeUTF8(std::u8string_view utf8str) noexcept {
     };
 }
 
+namespace detail {
+
+
+// Byte classes and transitions of a utf-8 validating DFA. Every byte value has a class; classes only
+// split where some state treats the bytes differently: the allowed second byte ranges after e0, ed, f0
+// and f4 exclude overlong sequences, surrogates and code points above CODE_POINT_MAX.
+enum UTF8_CLASS : uint8_t {
+    UTF8_ASCII, UTF8_TRAIL_80, UTF8_TRAIL_90, UTF8_TRAIL_A0, UTF8_INVALID, UTF8_LEAD_2,
+    UTF8_LEAD_E0, UTF8_LEAD_3, UTF8_LEAD_ED, UTF8_LEAD_F0, UTF8_LEAD_4, UTF8_LEAD_F4
+};
+inline constexpr size_t UTF8_CLASS_COUNT {12};
+
+// ACCEPT and REJECT end a sequence; every other state awaits one or more trail bytes.
+enum UTF8_STATE : uint8_t {
+    UTF8_ACCEPT, UTF8_REJECT, UTF8_NEED_1, UTF8_NEED_2, UTF8_NEED_3,
+    UTF8_AFTER_E0, UTF8_AFTER_ED, UTF8_AFTER_F0, UTF8_AFTER_F4
+};
+inline constexpr size_t UTF8_STATE_COUNT {9};
+
+
+inline constexpr std::array<uint8_t, 256> UTF8_BYTE_CLASS = [] {
+    std::array<uint8_t, 256> table{};
+    for (size_t byte = 0; byte < table.size(); ++byte) {
+        uint8_t c = UTF8_INVALID;
+        if (byte < 0x80)                     { c = UTF8_ASCII; }
+        else if (byte < 0x90)                { c = UTF8_TRAIL_80; }
+        else if (byte < 0xa0)                { c = UTF8_TRAIL_90; }
+        else if (byte < 0xc0)                { c = UTF8_TRAIL_A0; }
+        else if (byte < 0xc2)                { c = UTF8_INVALID; }
+        else if (byte < 0xe0)                { c = UTF8_LEAD_2; }
+        else if (byte == 0xe0)               { c = UTF8_LEAD_E0; }
+        else if (byte == 0xed)               { c = UTF8_LEAD_ED; }
+        else if (byte < 0xf0)                { c = UTF8_LEAD_3; }
+        else if (byte == 0xf0)               { c = UTF8_LEAD_F0; }
+        else if (byte < 0xf4)                { c = UTF8_LEAD_4; }
+        else if (byte == 0xf4)               { c = UTF8_LEAD_F4; }
+        table[byte] = c;
+    }
+    return table;
+}();
+
+
+// Payload bits of a lead byte by class; trail bytes always contribute their low 6 bits.
+inline constexpr std::array<uint8_t, UTF8_CLASS_COUNT> UTF8_LEAD_MASK = {
+    0x7f, 0, 0, 0, 0, 0x1f, 0x0f, 0x0f, 0x0f, 0x07, 0x07, 0x07
+};
+
+
+// Indexed by state * UTF8_CLASS_COUNT + class
+inline constexpr std::array<uint8_t, UTF8_STATE_COUNT * UTF8_CLASS_COUNT> UTF8_TRANSITION = [] {
+    std::array<uint8_t, UTF8_STATE_COUNT * UTF8_CLASS_COUNT> table{};
+    table.fill(UTF8_REJECT);
+    auto set = [&table](uint8_t state, uint8_t c, uint8_t next) { table[state * UTF8_CLASS_COUNT + c] = next; };
+    set(UTF8_ACCEPT, UTF8_ASCII,   UTF8_ACCEPT);
+    set(UTF8_ACCEPT, UTF8_LEAD_2,  UTF8_NEED_1);
+    set(UTF8_ACCEPT, UTF8_LEAD_E0, UTF8_AFTER_E0);
+    set(UTF8_ACCEPT, UTF8_LEAD_3,  UTF8_NEED_2);
+    set(UTF8_ACCEPT, UTF8_LEAD_ED, UTF8_AFTER_ED);
+    set(UTF8_ACCEPT, UTF8_LEAD_F0, UTF8_AFTER_F0);
+    set(UTF8_ACCEPT, UTF8_LEAD_4,  UTF8_NEED_3);
+    set(UTF8_ACCEPT, UTF8_LEAD_F4, UTF8_AFTER_F4);
+    for (uint8_t c : {UTF8_TRAIL_80, UTF8_TRAIL_90, UTF8_TRAIL_A0}) {
+        set(UTF8_NEED_1, c, UTF8_ACCEPT);
+        set(UTF8_NEED_2, c, UTF8_NEED_1);
+        set(UTF8_NEED_3, c, UTF8_NEED_2);
+    }
+    set(UTF8_AFTER_E0, UTF8_TRAIL_A0, UTF8_NEED_1);
+    set(UTF8_AFTER_ED, UTF8_TRAIL_80, UTF8_NEED_1);
+    set(UTF8_AFTER_ED, UTF8_TRAIL_90, UTF8_NEED_1);
+    set(UTF8_AFTER_F0, UTF8_TRAIL_90, UTF8_NEED_2);
+    set(UTF8_AFTER_F0, UTF8_TRAIL_A0, UTF8_NEED_2);
+    set(UTF8_AFTER_F4, UTF8_TRAIL_80, UTF8_NEED_2);
+    return table;
+}();
+
+
+} // namespace detail
+
+
+// Same results as DecodeUTF8, errors included. Valid sequences are checked and accumulated in one loop
+// of table lookups, with no separate length, trail, range or overlong tests. Invalid ones are handed to
+// DecodeUTF8, which tells the errors apart.
+constexpr DecodeData DecodeUTF8DFA(std::u8string_view utf8str) noexcept {
+    if (utf8str.empty()) { return DecodeData{.error_code=UTF_ERROR::INCOMPLETE_SEQUENCE}; }
+
+    const char8_t lead = utf8str[0];
+    const uint8_t lead_class = detail::UTF8_BYTE_CLASS[lead];
+    char32_t code_point = lead & detail::UTF8_LEAD_MASK[lead_class];
+    uint8_t state = detail::UTF8_TRANSITION[lead_class];
+    size_t length = 1;
+    while (state > detail::UTF8_REJECT && length < utf8str.size()) {
+        const char8_t trail = utf8str[length++];
+        code_point = (code_point << 6) | (trail & 0x3f);
+        state = detail::UTF8_TRANSITION[state * detail::UTF8_CLASS_COUNT + detail::UTF8_BYTE_CLASS[trail]];
+    }
+    if (state == detail::UTF8_ACCEPT) {
+        return DecodeData{.consumed=length, .code_point=code_point, .error_code=UTF_ERROR::OK};
+    }
+    return DecodeUTF8(utf8str);
+}
+
+
+// Number of utf-8 code units EncodeUTF8 produces for code_point.
+constexpr size_t EncodedLengthUTF8(char32_t code_point) noexcept {
+    if (code_point < 0x80)          { return 1; }
+    else if (code_point < 0x800)    { return 2; }
+    else if (code_point < 0x10000)  { return 3; } // surrogates encode as REPLACEMENT_CHARACTER, also 3 bytes
+    else if (code_point <= CODE_POINT_MAX) { return 4; }
+    return 3;
+}
+
 // Assumes code_point has been validated; will be converted to REPLACEMENT_CHARACTER if not valid.
-constexpr std::u8string EncodeUTF8(char32_t code_point) {
+// out must have room for 4 code units; returns the number of code units written.
+constexpr size_t EncodeUTF8(char32_t code_point, char8_t* out) noexcept {
     if (!is_code_point_valid(code_point)) { code_point = REPLACEMENT_CHARACTER; }
     if (code_point < 0x80) {                     // 1 byte
-        return std::u8string{{static_cast<char8_t>(code_point)}};
+        out[0] = static_cast<char8_t>(code_point);
+        return 1;
     } else if (code_point < 0x800) {             // 2 bytes
-        return std::u8string{{
-            static_cast<char8_t>((code_point >> 6)          | 0xc0),
-            static_cast<char8_t>((code_point & 0x3f)        | 0x80)
-        }};
+        out[0] = static_cast<char8_t>((code_point >> 6)          | 0xc0);
+        out[1] = static_cast<char8_t>((code_point & 0x3f)        | 0x80);
+        return 2;
     } else if (code_point < 0x10000) {           // 3 bytes
-        return std::u8string{{
-            static_cast<char8_t>((code_point >> 12)         | 0xe0),
-            static_cast<char8_t>(((code_point >> 6) & 0x3f) | 0x80),
-            static_cast<char8_t>((code_point & 0x3f)        | 0x80)
-        }};
+        out[0] = static_cast<char8_t>((code_point >> 12)         | 0xe0);
+        out[1] = static_cast<char8_t>(((code_point >> 6) & 0x3f) | 0x80);
+        out[2] = static_cast<char8_t>((code_point & 0x3f)        | 0x80);
+        return 3;
     }                                            // 4 bytes
-    return std::u8string{{
-        static_cast<char8_t>((code_point >> 18)             | 0xf0),
-        static_cast<char8_t>(((code_point >> 12) & 0x3f)    | 0x80),
-        static_cast<char8_t>(((code_point >> 6) & 0x3f)     | 0x80),
-        static_cast<char8_t>((code_point & 0x3f)            | 0x80)
-    }};
+    out[0] = static_cast<char8_t>((code_point >> 18)             | 0xf0);
+    out[1] = static_cast<char8_t>(((code_point >> 12) & 0x3f)    | 0x80);
+    out[2] = static_cast<char8_t>(((code_point >> 6) & 0x3f)     | 0x80);
+    out[3] = static_cast<char8_t>((code_point & 0x3f)            | 0x80);
+    return 4;
+}
+
+constexpr size_t EncodeUTF8(char32_t code_point, std::span<char8_t, 4> out) noexcept {
+    return EncodeUTF8(code_point, out.data());
+}
+
+constexpr std::u8string EncodeUTF8(char32_t code_point) {
+    char8_t buffer[4]{};
+    return std::u8string(buffer, EncodeUTF8(code_point, buffer));
 }
 
 constexpr DecodeData DecodeUTF16(std::u16string_view utf16str) noexcept {
@@ -159,15 +272,32 @@ constexpr DecodeData DecodeUTF16(std::u16string_view utf16str) noexcept {
     };
 }
 
+// Number of utf-16 code units EncodeUTF16 produces for code_point.
+constexpr size_t EncodedLengthUTF16(char32_t code_point) noexcept {
+    return (code_point > 0xffff && code_point <= CODE_POINT_MAX) ? 2 : 1;
+}
+
 // Assumes code_point has been validated; will be converted to REPLACEMENT_CHARACTER if not valid.
-constexpr std::u16string EncodeUTF16(char32_t code_point) {
+// out must have room for 2 code units; returns the number of code units written.
+constexpr size_t EncodeUTF16(char32_t code_point, char16_t* out) noexcept {
     if (!is_code_point_valid(code_point)) { code_point = REPLACEMENT_CHARACTER; }
-    if (IsInBMP(code_point)) { return std::u16string{{static_cast<char16_t>(code_point)}}; }
+    if (IsInBMP(code_point)) {
+        out[0] = static_cast<char16_t>(code_point);
+        return 1;
+    }
     // Code points from the supplementary planes are encoded via surrogate pairs
-    return std::u16string{{
-        static_cast<char16_t>(LEAD_OFFSET + (code_point >> 10)),
-        static_cast<char16_t>(TRAIL_SURROGATE_MIN + (code_point & 0x3FF))
-    }};
+    out[0] = static_cast<char16_t>(LEAD_OFFSET + (code_point >> 10));
+    out[1] = static_cast<char16_t>(TRAIL_SURROGATE_MIN + (code_point & 0x3FF));
+    return 2;
+}
+
+constexpr size_t EncodeUTF16(char32_t code_point, std::span<char16_t, 2> out) noexcept {
+    return EncodeUTF16(code_point, out.data());
+}
+
+constexpr std::u16string EncodeUTF16(char32_t code_point) {
+    char16_t buffer[2]{};
+    return std::u16string(buffer, EncodeUTF16(code_point, buffer));
 }
 
 
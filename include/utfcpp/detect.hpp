@@ -0,0 +1,216 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/core.hpp"
+#include "utfcpp/endian.hpp"
+#include "utfcpp/latin1.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/utility.hpp"
+
+
+/***
+ * Encoding detection
+ *
+ * A byte order mark decides the encoding on its own. Without one, only a bounded prefix is inspected:
+ * utf-16 and utf-32 text in the usual scripts has NUL bytes at telling positions, which are counted a
+ * vector at a time, and the candidate encoding must then validate over the prefix. Text without NULs is
+ * utf-8 if the prefix is valid utf-8, otherwise Latin-1. utf-16 without a BOM and with no code units below
+ * 0x100, e.g. pure CJK text, has no NUL bytes and is not recognised.
+ */
+namespace utfcpp {
+
+
+enum class ENCODING : uint32_t {
+    UTF8,
+    UTF16LE,
+    UTF16BE,
+    UTF32LE,
+    UTF32BE,
+    LATIN1,
+    UNKNOWN  // NUL bytes in no utf-16 or utf-32 pattern, and not valid utf-8: binary data
+};
+
+
+constexpr std::string ToString(ENCODING e) {
+    switch (e) {
+    case ENCODING::UTF8:    return {"UTF-8"};
+    case ENCODING::UTF16LE: return {"UTF-16LE"};
+    case ENCODING::UTF16BE: return {"UTF-16BE"};
+    case ENCODING::UTF32LE: return {"UTF-32LE"};
+    case ENCODING::UTF32BE: return {"UTF-32BE"};
+    case ENCODING::LATIN1:  return {"ISO-8859-1"};
+    case ENCODING::UNKNOWN: return {"unknown"};
+    default:
+        break;
+    }
+    return {"Unknown ENCODING"};
+}
+
+
+// Bytes of a blob DetectEncoding inspects past any byte order mark
+constexpr size_t DETECT_SAMPLE_SIZE {4096};
+
+
+// The text of the blob starts bom_size bytes in, after its byte order mark if it has one.
+struct DetectedEncoding {
+    ENCODING encoding{ENCODING::UTF8};
+    size_t bom_size{0};
+};
+
+
+namespace detail {
+
+
+// NUL bytes of bytes by offset modulo 4.
+using NulCounts = std::array<size_t, 4>;
+
+
+constexpr NulCounts CountNulsScalar(const std::byte* first, size_t size) noexcept {
+    NulCounts counts{};
+    for (size_t i = 0; i < size; ++i) { counts[i % 4] += first[i] == std::byte{0}; }
+    return counts;
+}
+
+
+#if defined(UTFCPP_SSE2)
+inline NulCounts CountNulsVector(const std::byte* first, size_t size) noexcept {
+    NulCounts counts{};
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        const uint32_t nuls = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_setzero_si128())));
+        for (size_t k = 0; k < 4; ++k) { counts[k] += std::popcount(nuls & (0x1111u << k)); }
+    }
+    const NulCounts tail = CountNulsScalar(first + i, size - i);
+    for (size_t k = 0; k < 4; ++k) { counts[k] += tail[k]; }
+    return counts;
+}
+#else
+inline NulCounts CountNulsVector(const std::byte* first, size_t size) noexcept {
+    return CountNulsScalar(first, size);
+}
+#endif
+
+
+constexpr NulCounts CountNuls(std::span<const std::byte> bytes) noexcept {
+    if consteval {
+        return CountNulsScalar(bytes.data(), bytes.size());
+    } else {
+        return CountNulsVector(bytes.data(), bytes.size());
+    }
+}
+
+
+constexpr bool StartsWith(std::span<const std::byte> bytes, std::initializer_list<uint8_t> prefix) noexcept {
+    return bytes.size() >= prefix.size() &&
+           std::ranges::equal(bytes.first(prefix.size()), prefix, {}, {}, [](uint8_t b) { return std::byte{b}; });
+}
+
+
+// Whether sample is valid in the encoding, except for a code point cut off at its end when sample is only
+// the start of the text.
+template <IsWideUTF_c T, std::endian Order>
+constexpr bool IsValidSample(std::span<const std::byte> sample, bool truncated) {
+    const size_t whole = sample.size() - sample.size() % sizeof(T);
+    const size_t invalid = FindInvalidEndian<T, Order>(sample.first(whole));
+    return invalid >= whole || (truncated && std::is_same_v<T, char16_t> && invalid + 2 == whole);
+}
+
+
+inline bool IsValidUTF8Sample(std::span<const std::byte> sample, bool truncated) {
+    const std::u8string_view utf8{reinterpret_cast<const char8_t*>(sample.data()), sample.size()};
+    const size_t invalid = FindInvalid(utf8);
+    return invalid >= utf8.size() ||
+           (truncated && DecodeUTF8(utf8.substr(invalid)).error_code == UTF_ERROR::INCOMPLETE_SEQUENCE);
+}
+
+
+} // namespace detail
+
+
+// Guesses the encoding of bytes from its byte order mark, or else from at most sample_size bytes of it.
+inline DetectedEncoding DetectEncoding(std::span<const std::byte> bytes, size_t sample_size = DETECT_SAMPLE_SIZE) {
+    // UTF-32LE before UTF-16LE, whose mark it starts with
+    if (detail::StartsWith(bytes, {0xff, 0xfe, 0x00, 0x00})) { return {ENCODING::UTF32LE, 4}; }
+    if (detail::StartsWith(bytes, {0x00, 0x00, 0xfe, 0xff})) { return {ENCODING::UTF32BE, 4}; }
+    if (detail::StartsWith(bytes, {0xef, 0xbb, 0xbf}))       { return {ENCODING::UTF8, 3}; }
+    if (detail::StartsWith(bytes, {0xff, 0xfe}))             { return {ENCODING::UTF16LE, 2}; }
+    if (detail::StartsWith(bytes, {0xfe, 0xff}))             { return {ENCODING::UTF16BE, 2}; }
+
+    const std::span<const std::byte> sample = bytes.first(std::min(bytes.size(), sample_size));
+    const bool truncated = sample.size() < bytes.size();
+    const detail::NulCounts nuls = detail::CountNuls(sample);
+    const size_t units32 = sample.size() / 4;
+    const size_t units16 = sample.size() / 2;
+
+    if (nuls[0] + nuls[1] + nuls[2] + nuls[3] != 0) {
+        // Every utf-32 code unit has a NUL top byte. utf-16 has NULs on one side only, in the high bytes of
+        // ASCII and Latin-1 code units, spaces and punctuation included.
+        if (units32 && nuls[3] >= units32 && detail::IsValidSample<char32_t, std::endian::little>(sample, truncated)) {
+            return {ENCODING::UTF32LE, 0};
+        }
+        if (units32 && nuls[0] >= units32 && detail::IsValidSample<char32_t, std::endian::big>(sample, truncated)) {
+            return {ENCODING::UTF32BE, 0};
+        }
+        const size_t odd = nuls[1] + nuls[3];
+        const size_t even = nuls[0] + nuls[2];
+        if (odd > 2 * even && 8 * odd >= units16 && detail::IsValidSample<char16_t, std::endian::little>(sample, truncated)) {
+            return {ENCODING::UTF16LE, 0};
+        }
+        if (even > 2 * odd && 8 * even >= units16 && detail::IsValidSample<char16_t, std::endian::big>(sample, truncated)) {
+            return {ENCODING::UTF16BE, 0};
+        }
+        return {detail::IsValidUTF8Sample(sample, truncated) ? ENCODING::UTF8 : ENCODING::UNKNOWN, 0};
+    }
+    return {detail::IsValidUTF8Sample(sample, truncated) ? ENCODING::UTF8 : ENCODING::LATIN1, 0};
+}
+
+
+// Converts bytes from the encoding DetectEncoding finds, without its byte order mark. Invalid input is
+// replaced as in UTFConvertTo; UNKNOWN input is read as utf-8.
+template <IsUTF_c Dst_t, typename Alloc_t=std::allocator<Dst_t>>
+std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> UTFConvertDetectedTo(std::span<const std::byte> bytes,
+                                                                              const Alloc_t& alloc = Alloc_t{}) {
+    const DetectedEncoding detected = DetectEncoding(bytes);
+    const std::span<const std::byte> text = bytes.subspan(detected.bom_size);
+    switch (detected.encoding) {
+    case ENCODING::UTF16LE: return UTFConvertEndianTo<char16_t, std::endian::little, Dst_t>(text, alloc);
+    case ENCODING::UTF16BE: return UTFConvertEndianTo<char16_t, std::endian::big, Dst_t>(text, alloc);
+    case ENCODING::UTF32LE: return UTFConvertEndianTo<char32_t, std::endian::little, Dst_t>(text, alloc);
+    case ENCODING::UTF32BE: return UTFConvertEndianTo<char32_t, std::endian::big, Dst_t>(text, alloc);
+    case ENCODING::LATIN1:
+        return Latin1ConvertTo<Dst_t>(std::string_view{reinterpret_cast<const char*>(text.data()), text.size()}, alloc);
+    default:
+        return UTFConvertTo<char8_t, Dst_t, UTFInputIterator, Alloc_t>(
+            std::u8string_view{reinterpret_cast<const char8_t*>(text.data()), text.size()}, alloc);
+    }
+}
+
+
+} // namespace utfcpp
@@ -0,0 +1,292 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/core.hpp"
+#include "utfcpp/decode_encode.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/utility.hpp"
+
+
+/***
+ * Byte order aware utf-16 and utf-32
+ *
+ * Raw byte buffers holding utf-16 or utf-32 in a given byte order, e.g. UTF-16BE read from a file or a
+ * socket. Code units are loaded a chunk at a time into a small buffer that stays in cache, byte swapped
+ * on the way when the order is not the native one, and each chunk goes through the same kernels as native
+ * text; no swapped copy of the whole input is made. A trailing partial code unit is an incomplete sequence.
+ */
+namespace utfcpp {
+
+
+namespace detail {
+
+
+// Code units loaded per chunk
+inline constexpr size_t ENDIAN_CHUNK_SIZE {1024};
+
+
+template <IsWideUTF_c T, std::endian Order>
+constexpr T LoadCodeUnit(const std::byte* src) noexcept {
+    uint32_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        const size_t shift = Order == std::endian::little ? 8 * i : 8 * (sizeof(T) - 1 - i);
+        value |= static_cast<uint32_t>(src[i]) << shift;
+    }
+    return static_cast<T>(value);
+}
+
+
+// Loads n code units of T stored in byte order Order from src into out, in native order.
+template <IsWideUTF_c T, std::endian Order>
+constexpr void LoadCodeUnits(const std::byte* src, size_t n, T* out) noexcept {
+    size_t i = 0;
+    if !consteval {
+        if constexpr (Order == std::endian::native) {
+            if (n) { std::memcpy(out, src, n * sizeof(T)); }
+            return;
+        }
+#if defined(UTFCPP_SSSE3)
+        constexpr size_t lanes = 16 / sizeof(T);
+        const __m128i swap = sizeof(T) == 2 ? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) :
+                                              _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        for (; i + lanes <= n; i += lanes) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(T)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(block, swap));
+        }
+#elif defined(UTFCPP_SSE2)
+        // Without a byte shuffle: 32-bit units swap their halves first, then every 16-bit half its bytes.
+        constexpr size_t lanes = 16 / sizeof(T);
+        for (; i + lanes <= n; i += lanes) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(T)));
+            if constexpr (sizeof(T) == 4) {
+                block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), block);
+        }
+#endif
+    }
+    for (; i < n; ++i) { out[i] = LoadCodeUnit<T, Order>(src + i * sizeof(T)); }
+}
+
+
+// Calls f(chunk, offset) with the whole code units of bytes in native order, a chunk at a time, until f
+// returns false; offset counts code units. Chunks end on code point boundaries. Native order text that is
+// suitably aligned is passed in place, as a single chunk.
+template <IsWideUTF_c T, std::endian Order, typename F>
+constexpr void ForEachEndianChunk(std::span<const std::byte> bytes, F&& f) {
+    const size_t units = bytes.size() / sizeof(T);
+    if !consteval {
+        if constexpr (Order == std::endian::native) {
+            if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(T) == 0) {
+                f(std::basic_string_view<T>{reinterpret_cast<const T*>(bytes.data()), units}, size_t{0});
+                return;
+            }
+        }
+    }
+    std::array<T, ENDIAN_CHUNK_SIZE> buffer{};
+    for (size_t pos = 0; pos < units;) {
+        const size_t n = std::min(buffer.size(), units - pos);
+        LoadCodeUnits<T, Order>(bytes.data() + pos * sizeof(T), n, buffer.data());
+        std::basic_string_view<T> chunk{buffer.data(), n};
+        if constexpr (std::is_same_v<T, char16_t>) {
+            // A lead surrogate waits for its trail in the next chunk
+            if (pos + n < units && IsLeadSurrogateUTF16(chunk.back())) { chunk.remove_suffix(1); }
+        }
+        if (!f(chunk, pos)) { return; }
+        pos += chunk.size();
+    }
+}
+
+
+} // namespace detail
+
+
+// Offset in bytes of the first invalid code point of bytes, which hold code units of T in byte order Order;
+// bytes.size() if valid.
+template <IsWideUTF_c T, std::endian Order>
+constexpr size_t FindInvalidEndian(std::span<const std::byte> bytes) {
+    size_t invalid = bytes.size() - bytes.size() % sizeof(T);
+    detail::ForEachEndianChunk<T, Order>(bytes, [&invalid](std::basic_string_view<T> chunk, size_t offset) {
+        const size_t pos = FindInvalid<T>(chunk);
+        if (pos < chunk.size()) { invalid = (offset + pos) * sizeof(T); }
+        return pos >= chunk.size();
+    });
+    return invalid;
+}
+
+
+template <IsWideUTF_c T, std::endian Order>
+constexpr bool IsValidEndian(std::span<const std::byte> bytes) {
+    return FindInvalidEndian<T, Order>(bytes) >= bytes.size();
+}
+
+
+// UTFConvertTo for code units of Src_t in byte order Order; the output is in native order.
+template <IsWideUTF_c Src_t, std::endian Order, IsUTF_c Dst_t, typename Alloc_t=std::allocator<Dst_t>>
+constexpr std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> UTFConvertEndianTo(std::span<const std::byte> bytes,
+                                                                                    const Alloc_t& alloc = Alloc_t{}) {
+    std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> result(alloc);
+    result.reserve(bytes.size() / sizeof(Src_t));
+    detail::ForEachEndianChunk<Src_t, Order>(bytes, [&result](std::basic_string_view<Src_t> chunk, size_t) {
+        UTFConvertAppend<Src_t, Dst_t>(chunk, result);
+        return true;
+    });
+    if (bytes.size() % sizeof(Src_t)) {
+        std::array<Dst_t, 4> replacement{};
+        result.append(replacement.data(), detail::WriteCodePoint(REPLACEMENT_CHARACTER, replacement.data()) - replacement.data());
+    }
+    return result;
+}
+
+
+// Reads code units of T in byte order Order straight from the bytes, splitting them into the same code
+// points, with the same errors, as UTFInputIterator over the native order text.
+template <IsWideUTF_c T, std::endian Order>
+class EndianIterator {
+public:
+    using self_t            = EndianIterator<T, Order>;
+    using value_type        = char32_t;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept  = std::forward_iterator_tag;
+
+    struct sentinel {};
+    friend constexpr bool operator==(const sentinel&, const self_t& iter) noexcept { return iter.first == iter.last; }
+    friend constexpr bool operator==(const self_t& iter, const sentinel&) noexcept { return iter.first == iter.last; }
+
+    constexpr EndianIterator() noexcept = default;
+    constexpr EndianIterator(std::span<const std::byte> bytes) noexcept
+        : first{bytes.data()}, last{bytes.data() + bytes.size()} {
+        _Fetch();
+    }
+
+    // The decoded fields are fully determined by first.
+    constexpr bool operator==(const EndianIterator& other) const noexcept { return first == other.first; }
+    constexpr auto operator<=>(const EndianIterator& other) const noexcept { return first <=> other.first; }
+
+    constexpr auto& operator++() noexcept {
+        if (first != last) {
+            first += next_index;
+            _Fetch();
+        }
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+    constexpr value_type operator*() const noexcept { return first == last ? REPLACEMENT_CHARACTER : code_point; }
+
+    // The remaining bytes
+    constexpr std::span<const std::byte> Data() const noexcept { return std::span<const std::byte>{first, last}; }
+
+    constexpr std::tuple<value_type, UTF_ERROR> Decode() const noexcept {
+        return first == last ?
+            std::tuple{REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT} :
+            std::tuple{code_point, error_code};
+    }
+
+    constexpr UTF_ERROR DecodeError() const noexcept {
+        return first == last ? UTF_ERROR::INVALID_CODE_POINT : error_code;
+    }
+
+private:
+    const std::byte* first{nullptr};
+    const std::byte* last{nullptr};
+    size_t next_index{sizeof(T)};  // in bytes
+    value_type code_point{REPLACEMENT_CHARACTER};
+    UTF_ERROR error_code{UTF_ERROR::INVALID_CODE_POINT};
+
+    constexpr void _Fetch() noexcept {
+        if (first == last) { return; }
+        const size_t available = static_cast<size_t>(last - first);
+        if (available < sizeof(T)) {
+            next_index = available;
+            code_point = REPLACEMENT_CHARACTER;
+            error_code = UTF_ERROR::INCOMPLETE_SEQUENCE;
+            return;
+        }
+        // Enough code units for any code point
+        std::array<T, 2> units{};
+        const size_t n = std::min(units.size(), available / sizeof(T));
+        for (size_t i = 0; i < n; ++i) { units[i] = detail::LoadCodeUnit<T, Order>(first + i * sizeof(T)); }
+        const DecodeData data = detail::DecodeOne(std::basic_string_view<T>{units.data(), n});
+        next_index = (data.consumed ? data.consumed : 1) * sizeof(T);
+        code_point = data.code_point;
+        error_code = data.error_code;
+    }
+};
+
+
+// The code points of bytes holding code units of T in byte order Order.
+template <IsWideUTF_c T, std::endian Order>
+class EndianView : public std::ranges::view_interface<EndianView<T, Order>> {
+public:
+    using iterator_type = EndianIterator<T, Order>;
+
+    constexpr EndianView(std::span<const std::byte> bytes) noexcept : bytes{bytes} {}
+
+    constexpr auto begin() const noexcept { return iterator_type{bytes}; }
+    constexpr auto end() const noexcept { return typename iterator_type::sentinel{}; }
+
+    constexpr bool empty() const noexcept { return bytes.empty(); }
+    constexpr      operator bool() const noexcept { return !bytes.empty(); }
+    constexpr auto data() const noexcept { return bytes; }
+    constexpr size_t size() const noexcept { return bytes.size(); }
+
+private:
+    std::span<const std::byte> bytes;
+};
+
+using utf16le_view = EndianView<char16_t, std::endian::little>;
+using utf16be_view = EndianView<char16_t, std::endian::big>;
+using utf32le_view = EndianView<char32_t, std::endian::little>;
+using utf32be_view = EndianView<char32_t, std::endian::big>;
+
+
+constexpr std::u8string utf16le_to_8(std::span<const std::byte> bytes)   { return UTFConvertEndianTo<char16_t, std::endian::little, char8_t>(bytes); }
+constexpr std::u16string utf16le_to_16(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char16_t, std::endian::little, char16_t>(bytes); }
+constexpr std::u32string utf16le_to_32(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char16_t, std::endian::little, char32_t>(bytes); }
+constexpr std::u8string utf16be_to_8(std::span<const std::byte> bytes)   { return UTFConvertEndianTo<char16_t, std::endian::big, char8_t>(bytes); }
+constexpr std::u16string utf16be_to_16(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char16_t, std::endian::big, char16_t>(bytes); }
+constexpr std::u32string utf16be_to_32(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char16_t, std::endian::big, char32_t>(bytes); }
+constexpr std::u8string utf32le_to_8(std::span<const std::byte> bytes)   { return UTFConvertEndianTo<char32_t, std::endian::little, char8_t>(bytes); }
+constexpr std::u16string utf32le_to_16(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char32_t, std::endian::little, char16_t>(bytes); }
+constexpr std::u32string utf32le_to_32(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char32_t, std::endian::little, char32_t>(bytes); }
+constexpr std::u8string utf32be_to_8(std::span<const std::byte> bytes)   { return UTFConvertEndianTo<char32_t, std::endian::big, char8_t>(bytes); }
+constexpr std::u16string utf32be_to_16(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char32_t, std::endian::big, char16_t>(bytes); }
+constexpr std::u32string utf32be_to_32(std::span<const std::byte> bytes) { return UTFConvertEndianTo<char32_t, std::endian::big, char32_t>(bytes); }
+
+
+} // namespace utfcpp
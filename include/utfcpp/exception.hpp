@@ -42,8 +42,8 @@ class DecodingError : public std::runtime_error {
 };
 
 
-auto OnDecodeErrorThrow_f = [](UTF_ERROR e) { throw DecodingError{ToString(e)}; };
-auto OnEncodeErrorThrow_f = [](UTF_ERROR e) { throw EncodingError{ToString(e)}; };
+inline constexpr auto OnDecodeErrorThrow_f = [](UTF_ERROR e) { throw DecodingError{ToString(e)}; };
+inline constexpr auto OnEncodeErrorThrow_f = [](UTF_ERROR e) { throw EncodingError{ToString(e)}; };
 
 
 } // namespace utfcpp
@@ -0,0 +1,189 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+/***
+ * Memory mapped file access
+ *
+ * Files are mapped rather than read, so validating or converting a file needs no copy of it in memory.
+ * View reads code units in native byte order; Bytes feeds files in other byte orders to the endian.hpp
+ * functions. Only available on POSIX systems.
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#  define UTFCPP_HAS_MMAP 1
+#endif
+
+#if defined(UTFCPP_HAS_MMAP)
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/core.hpp"
+#include "utfcpp/exception.hpp"
+#include "utfcpp/utility.hpp"
+
+
+namespace utfcpp {
+
+
+namespace detail {
+
+
+[[noreturn]] inline void ThrowFileError(const char* what) {
+    throw std::system_error{errno, std::generic_category(), what};
+}
+
+
+class FileDescriptor {
+public:
+    FileDescriptor(const std::filesystem::path& path, int flags, mode_t mode = 0) : fd{::open(path.c_str(), flags, mode)} {
+        if (fd < 0) { ThrowFileError("utfcpp: cannot open file"); }
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    ~FileDescriptor() { ::close(fd); }
+
+    int Get() const noexcept { return fd; }
+
+private:
+    int fd;
+};
+
+
+class Mapping {
+public:
+    Mapping() noexcept = default;
+    Mapping(int fd, size_t size, int protection) : size{size} {
+        if (!size) { return; } // mmap rejects empty mappings
+        void* address = ::mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) { ThrowFileError("utfcpp: cannot map file"); }
+        data = static_cast<std::byte*>(address);
+        ::madvise(data, size, MADV_SEQUENTIAL);
+    }
+    Mapping(Mapping&& other) noexcept
+        : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0)} {}
+    Mapping& operator=(Mapping&& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        return *this;
+    }
+    ~Mapping() { if (data) { ::munmap(data, size); } }
+
+    std::byte* Data() const noexcept { return data; }
+    size_t Size() const noexcept { return size; }
+
+private:
+    std::byte* data{nullptr};
+    size_t size{0};
+};
+
+
+template <IsUTF_c T>
+void CheckCodeUnitSize(size_t bytes) {
+    if (bytes % sizeof(T)) { throw DecodingError{ToString(UTF_ERROR::INCOMPLETE_SEQUENCE)}; }
+}
+
+
+} // namespace detail
+
+
+// Read-only mapping of a whole file, released when the object is destroyed.
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+        detail::FileDescriptor file{path, O_RDONLY | O_CLOEXEC};
+        struct stat info{};
+        if (::fstat(file.Get(), &info) != 0) { detail::ThrowFileError("utfcpp: cannot stat file"); }
+        mapping = detail::Mapping{file.Get(), static_cast<size_t>(info.st_size), PROT_READ};
+    }
+
+    // Contents as code units of T; throws DecodingError if the file ends in the middle of a code unit.
+    template <IsUTF_c T>
+    std::basic_string_view<T> View() const {
+        detail::CheckCodeUnitSize<T>(mapping.Size());
+        return {reinterpret_cast<const T*>(mapping.Data()), mapping.Size() / sizeof(T)};
+    }
+
+    // Contents as raw bytes, e.g. for EndianView or DetectEncoding
+    std::span<const std::byte> Bytes() const noexcept { return {mapping.Data(), mapping.Size()}; }
+
+    size_t Size() const noexcept { return mapping.Size(); }
+
+private:
+    detail::Mapping mapping{};
+};
+
+
+// Offset in code units of the first invalid code point in the file; the file's length in code units if valid.
+template <IsUTF_c T>
+size_t FindInvalidInFile(const std::filesystem::path& path) {
+    return FindInvalid<T>(MappedFile{path}.View<T>());
+}
+
+
+template <IsUTF_c T>
+bool IsValidFile(const std::filesystem::path& path) {
+    const MappedFile file{path};
+    return IsValid<T>(file.View<T>());
+}
+
+
+// UTFConvertTo over the mapped contents of the file.
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+std::basic_string<Dst_t> UTFConvertFileTo(const std::filesystem::path& path) {
+    const MappedFile file{path};
+    return UTFConvertTo<Src_t, Dst_t>(file.View<Src_t>());
+}
+
+
+// Converts src_path into dst_path, which is created or truncated, sized by an exact length pre-pass and
+// written through a mapping. Returns the number of Dst_t code units written.
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+size_t UTFConvertFile(const std::filesystem::path& src_path, const std::filesystem::path& dst_path) {
+    if (std::filesystem::exists(dst_path) && std::filesystem::equivalent(src_path, dst_path)) {
+        throw std::invalid_argument{"utfcpp: cannot convert a file onto itself"};
+    }
+    const MappedFile src_file{src_path};
+    const std::basic_string_view<Src_t> src = src_file.View<Src_t>();
+    const size_t length = EncodedLength<Dst_t, Src_t>(src);
+
+    detail::FileDescriptor dst_file{dst_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644};
+    if (::ftruncate(dst_file.Get(), static_cast<off_t>(length * sizeof(Dst_t))) != 0) {
+        detail::ThrowFileError("utfcpp: cannot resize file");
+    }
+    const detail::Mapping dst{dst_file.Get(), length * sizeof(Dst_t), PROT_READ | PROT_WRITE};
+    Dst_t* const out = reinterpret_cast<Dst_t*>(dst.Data());
+    detail::Transcode<Src_t, Dst_t>(src, out, out + length);
+    return length;
+}
+
+
+} // namespace utfcpp
+
+#endif // UTFCPP_HAS_MMAP
@@ -0,0 +1,88 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/utility.hpp"
+#include "utfcpp/views.hpp"
+
+
+namespace utfcpp {
+
+
+/***
+ * Sparse code point index
+ *
+ * Records the code unit offset of every stride-th code point of a string, so the offset of any code point
+ * is found by skipping fewer than stride code points from the nearest recorded one. Costs one size_t per
+ * stride code points. Code points are split as UTFView splits them, invalid code units included.
+ * The index refers to the string it was built from, which must outlive it.
+ */
+template <IsUTF_c T>
+class CodePointIndex {
+public:
+    using string_view_type = std::basic_string_view<T>;
+
+    static constexpr size_t DEFAULT_STRIDE {256};
+
+    constexpr CodePointIndex() = default;
+    constexpr explicit CodePointIndex(string_view_type str_view, size_t stride = DEFAULT_STRIDE)
+        : str{str_view}, stride{std::max(stride, size_t{1})} {
+        size_t pos = 0;
+        while (pos < str.size()) {
+            const string_view_type rest = str.substr(pos);
+            const size_t skipped = CodePointOffset(rest, this->stride);
+            if (skipped >= rest.size()) {
+                count += CountCodePoints(rest);
+                break;
+            }
+            pos += skipped;
+            count += this->stride;
+            offsets.push_back(pos);
+        }
+    }
+
+    // Offset in code units of code point n, or Data().size() if there are no more than n code points
+    constexpr size_t Offset(size_t n) const noexcept {
+        if (n >= count) { return str.size(); }
+        const size_t base = offsets[n / stride];
+        return base + CodePointOffset(str.substr(base), n % stride);
+    }
+
+    // The code points from n on
+    constexpr UTFView<T> View(size_t n) const noexcept { return UTFView<T>{str.substr(Offset(n))}; }
+
+    // Number of code points in the indexed string
+    constexpr size_t Size() const noexcept { return count; }
+
+    constexpr size_t Stride() const noexcept { return stride; }
+
+    constexpr string_view_type Data() const noexcept { return str; }
+
+private:
+    string_view_type str{};
+    size_t stride{DEFAULT_STRIDE};
+    size_t count{0};
+    std::vector<size_t> offsets{0};
+};
+
+
+} // namespace utfcpp
@@ -16,6 +16,9 @@
 
 
 #include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
 #include <string_view>
 #include <tuple>
 #include <utility>
@@ -23,13 +26,29 @@
 #include "utfcpp/concepts.hpp"
 #include "utfcpp/core.hpp"
 #include "utfcpp/decode_encode.hpp"
+#include "utfcpp/simd.hpp"
 
 
 namespace utfcpp {
 
 
+namespace detail {
+
+
+template <IsUTF_c T, IsCodeUnitSink_c<T> Sink_t>
+constexpr void AppendCodeUnits(Sink_t& sink, const T* data, size_t n) {
+    if constexpr (IsAppendSink_c<Sink_t, T>)      { sink.append(data, n); }
+    else if constexpr (IsInsertSink_c<Sink_t, T>) { sink.insert(sink.end(), data, data + n); }
+    else                                          { for (size_t i = 0; i < n; ++i) { sink.push_back(data[i]); } }
+}
+
+
+} // namespace detail
+
+
 // Derived from c++ standard library; back_insert_iterator / back_inserter
-template <IsUTF_c T>
+// Encodes code points as T and appends each one to the sink in a single call.
+template <IsUTF_c T, IsCodeUnitSink_c<T> Sink_t = std::basic_string<T>>
 class CodePointAppendIterator { // wrap pushes to back of container as output iterator
 public:
     using iterator_category = std::output_iterator_tag;
@@ -37,15 +56,21 @@ public:
     using pointer           = void;
     using reference         = void;
 
-    using container_type = std::basic_string<T>;
+    using container_type = Sink_t;
     using difference_type = ptrdiff_t;
 
-    constexpr explicit CodePointAppendIterator(container_type& str) noexcept : container(std::addressof(str)) {}
+    constexpr explicit CodePointAppendIterator(container_type& sink) noexcept : container(std::addressof(sink)) {}
 
     constexpr CodePointAppendIterator& operator=(const char32_t& code_point) {
-        if constexpr (std::is_same_v<T, char8_t>)       { container->append_range(EncodeUTF8(code_point)); }
-        else if constexpr (std::is_same_v<T, char16_t>) { container->append_range(EncodeUTF16(code_point)); }
-        else { container->push_back(code_point); }
+        if constexpr (std::is_same_v<T, char8_t>) {
+            char8_t buffer[4];
+            detail::AppendCodeUnits(*container, buffer, EncodeUTF8(code_point, buffer));
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            char16_t buffer[2];
+            detail::AppendCodeUnits(*container, buffer, EncodeUTF16(code_point, buffer));
+        } else {
+            detail::AppendCodeUnits(*container, &code_point, 1);
+        }
         return *this;
     }
 
@@ -58,9 +83,21 @@ protected:
 };
 
 
-template <IsUTF_c T>
-[[nodiscard]] constexpr CodePointAppendIterator<T> CodePointAppender(std::basic_string<T>& str) noexcept {
-    return CodePointAppendIterator<T>(str);
+template <typename Sink_t>
+CodePointAppendIterator(Sink_t&) -> CodePointAppendIterator<typename Sink_t::value_type, Sink_t>;
+
+
+// The code unit type is the sink's value_type ...
+template <typename Sink_t> requires IsUTF_c<typename Sink_t::value_type>
+[[nodiscard]] constexpr CodePointAppendIterator<typename Sink_t::value_type, Sink_t> CodePointAppender(Sink_t& sink) noexcept {
+    return CodePointAppendIterator<typename Sink_t::value_type, Sink_t>(sink);
+}
+
+
+// ... or given explicitly, e.g. CodePointAppender<char8_t>(bytes) for a std::vector<char>.
+template <IsUTF_c T, IsCodeUnitSink_c<T> Sink_t>
+[[nodiscard]] constexpr CodePointAppendIterator<T, Sink_t> CodePointAppender(Sink_t& sink) noexcept {
+    return CodePointAppendIterator<T, Sink_t>(sink);
 }
 
 
@@ -80,24 +117,17 @@ public:
 
     constexpr UTFInputIterator() noexcept = default;
     constexpr UTFInputIterator(string_view_type str_view) noexcept : rng{str_view} {
-        if (!rng.empty()) {
-            DecodeData data = _Decode();
-            next_index = data.consumed;
-            code_point = data.code_point;
-            error_code = data.error_code;
-        }
+        if (!rng.empty()) { _Fetch(); }
     }
-    constexpr auto operator<=>(const UTFInputIterator&) const noexcept = default;
+
+    // ascii_run is a lookahead cache; the remaining fields are fully determined by rng.
+    constexpr bool operator==(const UTFInputIterator& other) const noexcept { return rng == other.rng; }
+    constexpr auto operator<=>(const UTFInputIterator& other) const noexcept { return rng <=> other.rng; }
 
     constexpr auto& operator++() noexcept {
         if (!rng.empty()) {
             rng = _Advance(next_index);
-            if (!rng.empty()) {
-                DecodeData data = _Decode();
-                next_index = data.consumed;
-                code_point = data.code_point;
-                error_code = data.error_code;
-            }
+            if (!rng.empty()) { _Fetch(); }
         }
         return *this;
     }
@@ -123,11 +153,30 @@ private:
     size_t next_index{0};
     value_type code_point{REPLACEMENT_CHARACTER};
     UTF_ERROR error_code{UTF_ERROR::INVALID_CODE_POINT};
+    size_t ascii_run{0}; // code units following the current one known to be ASCII
 
     constexpr string_view_type _Advance(const size_t consumed) const noexcept {
         return string_view_type{rng.begin() + (consumed ? consumed : 1), rng.end()};
     }
 
+    constexpr void _Fetch() noexcept {
+        if constexpr (std::is_same_v<T, char8_t>) {
+            // ASCII runs are found one block at a time and then stepped through without decoding.
+            const char8_t lead = rng.front();
+            if (ascii_run || lead < 0x80) {
+                ascii_run = ascii_run ? ascii_run - 1 : AsciiPrefixLength(rng.substr(0, ASCII_BLOCK_SIZE)) - 1;
+                next_index = 1;
+                code_point = static_cast<value_type>(lead);
+                error_code = UTF_ERROR::OK;
+                return;
+            }
+        }
+        DecodeData data = _Decode();
+        next_index = data.consumed;
+        code_point = data.code_point;
+        error_code = data.error_code;
+    }
+
     constexpr DecodeData _Decode() const noexcept {
         if constexpr (std::is_same_v<T, char8_t>) {
             return DecodeUTF8(rng);
@@ -137,15 +186,15 @@ private:
             value_type code_point = rng.front();
             if (!is_code_point_valid(code_point)) {
                 return DecodeData{
-                    .error_code=UTF_ERROR::INVALID_CODE_POINT,
+                    .consumed=1,
                     .code_point=REPLACEMENT_CHARACTER,
-                    .consumed=1
+                    .error_code=UTF_ERROR::INVALID_CODE_POINT
                 };
             }
             return DecodeData{
-                .error_code=UTF_ERROR::OK,
+                .consumed=1,
                 .code_point=code_point,
-                .consumed=1
+                .error_code=UTF_ERROR::OK
             };
         }
     }
@@ -205,4 +254,418 @@ private:
 };
 
 
+// Decodes forwards like UTFInputIterator and also backwards, by scanning back at most 3 trail bytes or
+// one trail surrogate, so suffixes of long strings can be walked without decoding from the start.
+// Both directions split the string into the same code points, errors included.
+template <IsUTF_c T>
+class UTFBidirectionalIterator {
+public:
+    using self_t            = UTFBidirectionalIterator<T>;
+    using string_view_type  = std::basic_string_view<T>;
+    using value_type        = char32_t;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    using iterator_category = std::input_iterator_tag; // dereferencing yields a value, not a reference
+    using iterator_concept  = std::bidirectional_iterator_tag;
+
+    struct sentinel {};
+    friend constexpr bool operator==(const sentinel&, const self_t& iter) noexcept { return iter.pos == iter.str.size(); }
+    friend constexpr bool operator==(const self_t& iter, const sentinel&) noexcept { return iter.pos == iter.str.size(); }
+
+    constexpr UTFBidirectionalIterator() noexcept = default;
+    constexpr UTFBidirectionalIterator(string_view_type str_view) noexcept : UTFBidirectionalIterator(str_view, 0) {}
+    constexpr UTFBidirectionalIterator(string_view_type str_view, size_t pos) noexcept : str{str_view}, pos{pos} {
+        _Fetch();
+    }
+
+    // Iterator positioned at the end of str_view; the past-the-end iterator of a common range.
+    static constexpr self_t End(string_view_type str_view) noexcept { return self_t{str_view, str_view.size()}; }
+
+    constexpr bool operator==(const UTFBidirectionalIterator& other) const noexcept { return pos == other.pos; }
+    constexpr auto operator<=>(const UTFBidirectionalIterator& other) const noexcept { return pos <=> other.pos; }
+
+    constexpr auto& operator++() noexcept {
+        if (pos < str.size()) {
+            pos += next_index;
+            _Fetch();
+        }
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+    constexpr auto& operator--() noexcept {
+        if (pos > 0) {
+            pos = _PreviousPosition();
+            _Fetch();
+        }
+        return *this;
+    }
+
+    constexpr auto operator--(int) noexcept { auto tmp = *this; --*this; return tmp; }
+
+    constexpr value_type operator*() const noexcept { return pos < str.size() ? code_point : REPLACEMENT_CHARACTER; }
+
+    // Remaining code units, from the current code point to the end
+    constexpr string_view_type Data() const noexcept { return str.substr(pos); }
+
+    // Offset of the current code point in code units
+    constexpr size_t Position() const noexcept { return pos; }
+
+    constexpr std::tuple<value_type, UTF_ERROR> Decode() const noexcept {
+        return pos < str.size() ?
+            std::tuple{code_point, error_code} :
+            std::tuple{REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT};
+    }
+
+    constexpr UTF_ERROR DecodeError() const noexcept {
+        return pos < str.size() ? error_code : UTF_ERROR::INVALID_CODE_POINT;
+    }
+
+private:
+    string_view_type str{};
+    size_t pos{0};
+    size_t next_index{1};
+    value_type code_point{REPLACEMENT_CHARACTER};
+    UTF_ERROR error_code{UTF_ERROR::INVALID_CODE_POINT};
+
+    constexpr void _Fetch() noexcept {
+        if (pos >= str.size()) { return; }
+        DecodeData data = _Decode(pos);
+        next_index = data.consumed ? data.consumed : 1;
+        code_point = data.code_point;
+        error_code = data.error_code;
+    }
+
+    constexpr DecodeData _Decode(size_t at) const noexcept {
+        const string_view_type rng = str.substr(at);
+        if constexpr (std::is_same_v<T, char8_t>) {
+            return DecodeUTF8(rng);
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            return DecodeUTF16(rng);
+        } else {
+            return is_code_point_valid(rng.front()) ?
+                DecodeData{.consumed=1, .code_point=rng.front(), .error_code=UTF_ERROR::OK} :
+                DecodeData{.consumed=1, .code_point=REPLACEMENT_CHARACTER, .error_code=UTF_ERROR::INVALID_CODE_POINT};
+        }
+    }
+
+    // A valid sequence ending at pos starts at the nearest preceding non-trail code unit; anything else
+    // before pos decodes as an error, one code unit at a time.
+    constexpr size_t _PreviousPosition() const noexcept {
+        if constexpr (std::is_same_v<T, char8_t>) {
+            for (size_t back = 1; back <= 4 && back <= pos; ++back) {
+                if (!IsTrailUTF8(str[pos - back])) {
+                    const DecodeData data = _Decode(pos - back);
+                    return data.error_code == UTF_ERROR::OK && data.consumed == back ? pos - back : pos - 1;
+                }
+            }
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            if (pos >= 2 && IsTrailSurrogateUTF16(str[pos - 1]) && IsLeadSurrogateUTF16(str[pos - 2])) { return pos - 2; }
+        }
+        return pos - 1;
+    }
+};
+
+
+// Two pointers and nothing else: trivially copyable, decodes on dereference and compares positions only.
+// Cheap to copy around in range pipelines; dereferencing and incrementing each check the sequence again.
+template <IsUTF_c T>
+class UTFLeanIterator {
+public:
+    using self_t            = UTFLeanIterator<T>;
+    using string_view_type  = std::basic_string_view<T>;
+    using value_type        = char32_t;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept  = std::forward_iterator_tag;
+
+    struct sentinel {};
+    friend constexpr bool operator==(const sentinel&, const self_t& iter) noexcept { return iter.first == iter.last; }
+    friend constexpr bool operator==(const self_t& iter, const sentinel&) noexcept { return iter.first == iter.last; }
+
+    constexpr UTFLeanIterator() noexcept = default;
+    constexpr UTFLeanIterator(string_view_type str_view) noexcept
+        : first{str_view.data()}, last{str_view.data() + str_view.size()} {}
+
+    constexpr bool operator==(const UTFLeanIterator& other) const noexcept { return first == other.first; }
+    constexpr auto operator<=>(const UTFLeanIterator& other) const noexcept { return first <=> other.first; }
+
+    constexpr auto& operator++() noexcept {
+        if (first != last) {
+            const size_t length = _ValidLength();
+            first += length ? length : 1;
+        }
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+    constexpr value_type operator*() const noexcept {
+        if (first == last) { return REPLACEMENT_CHARACTER; }
+        const value_type lead = static_cast<value_type>(*first);
+        if constexpr (std::is_same_v<T, char8_t>) {
+            switch (_ValidLength()) {
+            case 1: return lead;
+            case 2: return ((lead & 0x1f) << 6) | (first[1] & 0x3f);
+            case 3: return ((lead & 0x0f) << 12) | ((first[1] & 0x3f) << 6) | (first[2] & 0x3f);
+            case 4: return ((lead & 0x07) << 18) | ((first[1] & 0x3f) << 12) | ((first[2] & 0x3f) << 6) | (first[3] & 0x3f);
+            default: return REPLACEMENT_CHARACTER;
+            }
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            switch (_ValidLength()) {
+            case 1: return lead;
+            case 2: return SURROGATE_OFFSET + (lead << 10) + static_cast<value_type>(first[1]);
+            default: return REPLACEMENT_CHARACTER;
+            }
+        } else {
+            return is_code_point_valid(lead) ? lead : REPLACEMENT_CHARACTER;
+        }
+    }
+
+    constexpr string_view_type Data() const noexcept { return string_view_type{first, last}; }
+
+    constexpr std::tuple<value_type, UTF_ERROR> Decode() const noexcept {
+        if (first == last) { return {REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT}; }
+        const DecodeData data = _Decode();
+        return {data.code_point, data.error_code};
+    }
+
+    constexpr UTF_ERROR DecodeError() const noexcept {
+        return first == last ? UTF_ERROR::INVALID_CODE_POINT : _Decode().error_code;
+    }
+
+private:
+    const T* first{nullptr};
+    const T* last{nullptr};
+
+    // Length of the valid sequence at first, 0 if there is none. Cheaper than a full decode: the second
+    // byte's allowed range rules out overlong, surrogate and too large code points in one comparison.
+    constexpr size_t _ValidLength() const noexcept {
+        if constexpr (std::is_same_v<T, char8_t>) {
+            const char8_t lead = *first;
+            if (lead < 0x80) { return 1; }
+            if (lead < 0xc2 || lead > 0xf4) { return 0; }
+            const size_t length = SequenceLength(lead);
+            if (static_cast<size_t>(last - first) < length) { return 0; }
+            const char8_t second = first[1];
+            const char8_t second_min = lead == 0xe0 ? 0xa0 : (lead == 0xf0 ? 0x90 : 0x80);
+            const char8_t second_max = lead == 0xed ? 0x9f : (lead == 0xf4 ? 0x8f : 0xbf);
+            if (second < second_min || second > second_max) { return 0; }
+            for (size_t i = 2; i < length; ++i) {
+                if (!IsTrailUTF8(first[i])) { return 0; }
+            }
+            return length;
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            const char16_t unit = *first;
+            if (!IsSurrogateUTF16(unit)) { return 1; }
+            return IsLeadSurrogateUTF16(unit) && last - first >= 2 && IsTrailSurrogateUTF16(first[1]) ? 2 : 0;
+        } else {
+            return is_code_point_valid(*first) ? 1 : 0;
+        }
+    }
+
+    // Errors consume one code unit; at the end, the result is an error that consumes nothing.
+    constexpr DecodeData _Decode() const noexcept {
+        const string_view_type rng{first, last};
+        if constexpr (std::is_same_v<T, char8_t>) {
+            return DecodeUTF8(rng);
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            return DecodeUTF16(rng);
+        } else {
+            if (rng.empty()) { return DecodeData{.error_code=UTF_ERROR::INCOMPLETE_SEQUENCE}; }
+            return is_code_point_valid(rng.front()) ?
+                DecodeData{.consumed=1, .code_point=rng.front(), .error_code=UTF_ERROR::OK} :
+                DecodeData{.consumed=1, .code_point=REPLACEMENT_CHARACTER, .error_code=UTF_ERROR::INVALID_CODE_POINT};
+        }
+    }
+};
+
+
+
+// Trusts its input: decodes without validation, so it must only see data already checked once, e.g. by
+// IsValid. Every code point reports UTF_ERROR::OK. Invalid input decodes to unspecified code points but is
+// never read past its end.
+template <IsUTF_c T>
+class UncheckedUTFIterator {
+public:
+    using self_t            = UncheckedUTFIterator<T>;
+    using string_view_type  = std::basic_string_view<T>;
+    using value_type        = char32_t;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept  = std::forward_iterator_tag;
+
+    struct sentinel {};
+    friend constexpr bool operator==(const sentinel&, const self_t& iter) noexcept { return iter.first == iter.last; }
+    friend constexpr bool operator==(const self_t& iter, const sentinel&) noexcept { return iter.first == iter.last; }
+
+    constexpr UncheckedUTFIterator() noexcept = default;
+    constexpr UncheckedUTFIterator(string_view_type str_view) noexcept
+        : first{str_view.data()}, last{str_view.data() + str_view.size()} {}
+
+    constexpr bool operator==(const UncheckedUTFIterator& other) const noexcept { return first == other.first; }
+    constexpr auto operator<=>(const UncheckedUTFIterator& other) const noexcept { return first <=> other.first; }
+
+    // Steps by a constant per branch; predicted, the next code point is reached without waiting for
+    // this one's lead code unit to load.
+    constexpr auto& operator++() noexcept {
+        if (last - first < 4) {
+            // Near the end, where the step has to be cut short
+            if (first != last) { first += _Length(); }
+            return *this;
+        }
+        if constexpr (std::is_same_v<T, char8_t>) {
+            switch (*first >> 4) {
+            case 0xc: case 0xd: first += 2; break;
+            case 0xe:           first += 3; break;
+            case 0xf:           first += 4; break;
+            default:            first += 1; break;
+            }
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            if (IsLeadSurrogateUTF16(*first)) { first += 2; }
+            else                              { first += 1; }
+        } else {
+            first += 1;
+        }
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+    constexpr value_type operator*() const noexcept {
+        if (first == last) { return REPLACEMENT_CHARACTER; }
+        const value_type lead = static_cast<value_type>(*first);
+        if constexpr (std::is_same_v<T, char8_t>) {
+            switch (_Length()) {
+            case 2: return ((lead & 0x1f) << 6) | (first[1] & 0x3f);
+            case 3: return ((lead & 0x0f) << 12) | ((first[1] & 0x3f) << 6) | (first[2] & 0x3f);
+            case 4: return ((lead & 0x07) << 18) | ((first[1] & 0x3f) << 12) | ((first[2] & 0x3f) << 6) | (first[3] & 0x3f);
+            default: return lead;
+            }
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            return _Length() == 2 ? SURROGATE_OFFSET + (lead << 10) + static_cast<value_type>(first[1]) : lead;
+        } else {
+            return lead;
+        }
+    }
+
+    constexpr string_view_type Data() const noexcept { return string_view_type{first, last}; }
+
+    constexpr std::tuple<value_type, UTF_ERROR> Decode() const noexcept {
+        if (first == last) { return {REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT}; }
+        return {**this, UTF_ERROR::OK};
+    }
+
+    constexpr UTF_ERROR DecodeError() const noexcept {
+        return first == last ? UTF_ERROR::INVALID_CODE_POINT : UTF_ERROR::OK;
+    }
+
+private:
+    const T* first{nullptr};
+    const T* last{nullptr};
+
+    // Sequence length from the lead code unit alone, cut short at the end of the input.
+    constexpr size_t _Length() const noexcept {
+        if constexpr (std::is_same_v<T, char8_t>) {
+            const char8_t lead = *first;
+            const size_t rest = static_cast<size_t>(last - first);
+            size_t length = 4;
+            if (lead < 0xc0)      { length = 1; }
+            else if (lead < 0xe0) { length = 2; }
+            else if (lead < 0xf0) { length = 3; }
+            if (length > rest)    { length = rest; }
+            return length;
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            return IsLeadSurrogateUTF16(*first) && last - first >= 2 ? 2 : 1;
+        } else {
+            return 1;
+        }
+    }
+};
+
+
+// Decodes utf-8 with the table-driven DecodeUTF8DFA, once per code point, and has no ASCII shortcut:
+// suited to text that is mostly multi-byte. utf-16 and utf-32 decode as in UTFInputIterator.
+// Splits strings into the same code points, with the same errors, as UTFInputIterator.
+template <IsUTF_c T>
+class UTFDFAIterator {
+public:
+    using self_t            = UTFDFAIterator<T>;
+    using string_view_type  = std::basic_string_view<T>;
+    using value_type        = char32_t;
+    using size_type         = size_t;
+    using difference_type   = ptrdiff_t;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept  = std::forward_iterator_tag;
+
+    struct sentinel {};
+    friend constexpr bool operator==(const sentinel&, const self_t& iter) noexcept { return iter.first == iter.last; }
+    friend constexpr bool operator==(const self_t& iter, const sentinel&) noexcept { return iter.first == iter.last; }
+
+    constexpr UTFDFAIterator() noexcept = default;
+    constexpr UTFDFAIterator(string_view_type str_view) noexcept
+        : first{str_view.data()}, last{str_view.data() + str_view.size()} {
+        _Fetch();
+    }
+
+    // The decoded fields are fully determined by first.
+    constexpr bool operator==(const UTFDFAIterator& other) const noexcept { return first == other.first; }
+    constexpr auto operator<=>(const UTFDFAIterator& other) const noexcept { return first <=> other.first; }
+
+    constexpr auto& operator++() noexcept {
+        if (first != last) {
+            first += next_index;
+            _Fetch();
+        }
+        return *this;
+    }
+
+    constexpr auto operator++(int) noexcept { auto tmp = *this; ++*this; return tmp; }
+
+    constexpr value_type operator*() const noexcept { return first == last ? REPLACEMENT_CHARACTER : code_point; }
+
+    constexpr string_view_type Data() const noexcept { return string_view_type{first, last}; }
+
+    constexpr std::tuple<value_type, UTF_ERROR> Decode() const noexcept {
+        return first == last ?
+            std::tuple{REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT} :
+            std::tuple{code_point, error_code};
+    }
+
+    constexpr UTF_ERROR DecodeError() const noexcept {
+        return first == last ? UTF_ERROR::INVALID_CODE_POINT : error_code;
+    }
+
+private:
+    const T* first{nullptr};
+    const T* last{nullptr};
+    size_t next_index{1};
+    value_type code_point{REPLACEMENT_CHARACTER};
+    UTF_ERROR error_code{UTF_ERROR::INVALID_CODE_POINT};
+
+    constexpr void _Fetch() noexcept {
+        if (first == last) { return; }
+        const DecodeData data = _Decode();
+        next_index = data.consumed ? data.consumed : 1;
+        code_point = data.code_point;
+        error_code = data.error_code;
+    }
+
+    constexpr DecodeData _Decode() const noexcept {
+        const string_view_type rng{first, last};
+        if constexpr (std::is_same_v<T, char8_t>) {
+            return DecodeUTF8DFA(rng);
+        } else if constexpr (std::is_same_v<T, char16_t>) {
+            return DecodeUTF16(rng);
+        } else {
+            return is_code_point_valid(rng.front()) ?
+                DecodeData{.consumed=1, .code_point=rng.front(), .error_code=UTF_ERROR::OK} :
+                DecodeData{.consumed=1, .code_point=REPLACEMENT_CHARACTER, .error_code=UTF_ERROR::INVALID_CODE_POINT};
+        }
+    }
+};
+
 } // namespace utfcpp
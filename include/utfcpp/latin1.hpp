@@ -0,0 +1,309 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/core.hpp"
+#include "utfcpp/decode_encode.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/transcode.hpp"
+#include "utfcpp/utility.hpp"
+
+
+/***
+ * ISO-8859-1 (Latin-1) and ASCII
+ *
+ * Latin-1 text is held in plain char strings, one byte per code point: every byte value is the code point
+ * of the same value, so there is no invalid Latin-1. Conversions to Latin-1 decode as UTFView does and
+ * write one byte per code point; code points above 0xff, REPLACEMENT_CHARACTERs included, become the
+ * replacement byte.
+ */
+namespace utfcpp {
+
+
+// Default replacement byte for code points Latin-1 cannot represent.
+constexpr char LATIN1_REPLACEMENT {'?'};
+
+
+namespace detail {
+
+
+template <IsCodeUnit_c T>
+constexpr bool IsASCIIScalar(const T* first, size_t size) noexcept {
+    std::make_unsigned_t<T> bits = 0;
+    for (size_t i = 0; i < size; ++i) { bits |= static_cast<std::make_unsigned_t<T>>(first[i]); }
+    return bits < 0x80;
+}
+
+
+#if defined(UTFCPP_SSE2)
+// Wider code units are ORed together a block at a time; the top bits of any non-ASCII unit survive.
+template <IsCodeUnit_c T>
+inline bool IsASCIIVector(const T* first, size_t size) noexcept {
+    if constexpr (sizeof(T) == 1) {
+        const char8_t* bytes = reinterpret_cast<const char8_t*>(first);
+        return AsciiPrefixLength(std::u8string_view{bytes, size}) == size;
+    } else {
+        constexpr size_t lanes = 16 / sizeof(T);
+        const __m128i high = sizeof(T) == 2 ? _mm_set1_epi16(static_cast<short>(0xff80)) :
+                                              _mm_set1_epi32(static_cast<int>(0xffffff80));
+        size_t i = 0;
+        for (; i + 4 * lanes <= size; i += 4 * lanes) {
+            const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + lanes));
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 2 * lanes));
+            const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 3 * lanes));
+            const __m128i any = _mm_and_si128(_mm_or_si128(_mm_or_si128(b0, b1), _mm_or_si128(b2, b3)), high);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff) { return false; }
+        }
+        return IsASCIIScalar(first + i, size - i);
+    }
+}
+#else
+template <IsCodeUnit_c T>
+inline bool IsASCIIVector(const T* first, size_t size) noexcept {
+    if constexpr (sizeof(T) == 1) {
+        const char8_t* bytes = reinterpret_cast<const char8_t*>(first);
+        return AsciiPrefixLength(std::u8string_view{bytes, size}) == size;
+    } else {
+        return IsASCIIScalar(first, size);
+    }
+}
+#endif
+
+
+// Latin-1 to utf-16 or utf-32 is plain widening; to utf-8, ASCII blocks are copied and every other byte
+// becomes a 2 byte sequence. out must have room for Latin1EncodedLength code units.
+template <IsUTF_c Dst_t>
+constexpr Dst_t* TranscodeFromLatin1(std::string_view src, Dst_t* out) noexcept {
+    size_t i = 0;
+    if !consteval {
+#if defined(UTFCPP_SSE2)
+        if constexpr (std::is_same_v<Dst_t, char8_t>) {
+            // Mixed blocks are written without branches: the second byte is always stored and only kept
+            // for high bytes. Some byte of src follows every block, so there is room for it.
+            for (; i + 16 < src.size();) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i));
+                if (_mm_movemask_epi8(block) == 0) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+                    out += 16;
+                    i += 16;
+                    continue;
+                }
+                for (const size_t block_end = i + 16; i < block_end; ++i) {
+                    const char8_t byte = static_cast<char8_t>(src[i]);
+                    const bool high = byte >= 0x80;
+                    out[0] = high ? static_cast<char8_t>(0xc0 | (byte >> 6)) : byte;
+                    out[1] = static_cast<char8_t>(0x80 | (byte & 0x3f));
+                    out += 1 + high;
+                }
+            }
+        } else {
+            for (; i + 16 <= src.size(); i += 16, out += 16) {
+                WidenASCII16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i)), out);
+            }
+        }
+#endif
+    }
+    for (; i < src.size(); ++i) {
+        out = WriteCodePoint(static_cast<char32_t>(static_cast<unsigned char>(src[i])), out);
+    }
+    return out;
+}
+
+
+// Writes one byte per code point of src, as UTFView splits it; returns the end of the output.
+// out must have room for src.size() bytes.
+template <IsUTF_c Src_t>
+constexpr char* TranscodeToLatin1(std::basic_string_view<Src_t> src, char* out, char replacement) noexcept {
+    auto narrow = [replacement](char32_t code_point) {
+        return code_point <= 0xff ? static_cast<char>(code_point) : replacement;
+    };
+    size_t i = 0;
+    if !consteval {
+#if defined(UTFCPP_SSE2)
+        if constexpr (std::is_same_v<Src_t, char8_t>) {
+            // ASCII blocks are copied. Otherwise a fixed 8 code points are folded without branches while
+            // they are ASCII or 2 byte sequences, at most 16 bytes, so the trail byte read is always
+            // within src; anything else goes through the decoder and ends the round.
+            while (i + 16 < src.size()) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data() + i));
+                if (_mm_movemask_epi8(block) == 0) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+                    out += 16;
+                    i += 16;
+                    continue;
+                }
+                for (int step = 0; step < 8; ++step) {
+                    const char8_t lead = src[i];
+                    const char8_t trail = src[i + 1];
+                    const bool pair = (static_cast<unsigned>(lead - 0xc2) <= 0xdf - 0xc2) & ((trail & 0xc0) == 0x80);
+                    // Neither ASCII nor a 2 byte sequence; one comparison, where (lead >= 0x80 && !pair) is two branches.
+                    if ((lead >> 7) > pair) {
+                        const DecodeData data = DecodeUTF8DFA(src.substr(i));
+                        *out++ = narrow(data.code_point);
+                        i += data.consumed;
+                        break;
+                    }
+                    // Selects through masks; compilers tend to branch on the equivalent conditionals.
+                    const uint32_t pair_mask = 0u - pair;
+                    const uint32_t code_point = (lead & ~pair_mask) | ((((lead & 0x1fu) << 6) | (trail & 0x3fu)) & pair_mask);
+                    const uint32_t wide_mask = 0u - (code_point > 0xff);
+                    *out++ = static_cast<char>((code_point & ~wide_mask) | (static_cast<unsigned char>(replacement) & wide_mask));
+                    i += 1 + pair;
+                }
+            }
+        } else {
+            // Blocks of 16 code units that all fit in a byte are packed; any other block is decoded one
+            // code point at a time.
+            while (i + 16 <= src.size()) {
+                const __m128i* block = reinterpret_cast<const __m128i*>(src.data() + i);
+                __m128i packed{};
+                bool narrow_block = false;
+                if constexpr (std::is_same_v<Src_t, char16_t>) {
+                    const __m128i b0 = _mm_loadu_si128(block);
+                    const __m128i b1 = _mm_loadu_si128(block + 1);
+                    const __m128i high = _mm_and_si128(_mm_or_si128(b0, b1), _mm_set1_epi16(static_cast<short>(0xff00)));
+                    narrow_block = _mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xffff;
+                    packed = _mm_packus_epi16(b0, b1);
+                } else {
+                    const __m128i b0 = _mm_loadu_si128(block);
+                    const __m128i b1 = _mm_loadu_si128(block + 1);
+                    const __m128i b2 = _mm_loadu_si128(block + 2);
+                    const __m128i b3 = _mm_loadu_si128(block + 3);
+                    const __m128i any = _mm_or_si128(_mm_or_si128(b0, b1), _mm_or_si128(b2, b3));
+                    const __m128i high = _mm_and_si128(any, _mm_set1_epi32(static_cast<int>(0xffffff00)));
+                    narrow_block = _mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) == 0xffff;
+                    packed = _mm_packus_epi16(_mm_packs_epi32(b0, b1), _mm_packs_epi32(b2, b3));
+                }
+                if (narrow_block) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
+                    out += 16;
+                    i += 16;
+                    continue;
+                }
+                for (const size_t block_end = i + 16; i < block_end;) {
+                    if (std::is_same_v<Src_t, char16_t> && (src[i] < 0xd800 || src[i] > 0xdfff)) {
+                        *out++ = narrow(src[i++]);
+                        continue;
+                    }
+                    const DecodeData data = DecodeOne(src.substr(i));
+                    *out++ = narrow(data.code_point);
+                    i += data.consumed;
+                }
+            }
+        }
+#endif
+    }
+    while (i < src.size()) {
+        const DecodeData data = DecodeOne(src.substr(i));
+        *out++ = narrow(data.code_point);
+        i += data.consumed;
+    }
+    return out;
+}
+
+
+} // namespace detail
+
+
+// True if every code unit of src is below 0x80; such text is the same in ASCII, Latin-1 and utf-8.
+template <IsCodeUnit_c T>
+constexpr bool IsASCII(std::basic_string_view<T> src) noexcept {
+    if consteval {
+        return detail::IsASCIIScalar(src.data(), src.size());
+    } else {
+        return detail::IsASCIIVector(src.data(), src.size());
+    }
+}
+
+
+// Exact number of Dst_t code units Latin1ConvertTo produces for src.
+template <IsUTF_c Dst_t>
+constexpr size_t Latin1EncodedLength(std::string_view src) noexcept {
+    if constexpr (std::is_same_v<Dst_t, char8_t>) {
+        if consteval {
+            size_t length = src.size();
+            for (char ch : src) { length += static_cast<unsigned char>(ch) >= 0x80; }
+            return length;
+        } else {
+            const std::u8string_view bytes{reinterpret_cast<const char8_t*>(src.data()), src.size()};
+            return src.size() + detail::CountBytesInRange(bytes, 0x80, 0xff);
+        }
+    } else {
+        return src.size();
+    }
+}
+
+
+// The code points of Latin-1 text, for use wherever a UTFView is, e.g. std::ranges::copy into a CodePointAppender.
+constexpr auto Latin1View(std::string_view src) noexcept {
+    return src | std::views::transform([](char ch) { return static_cast<char32_t>(static_cast<unsigned char>(ch)); });
+}
+
+
+template <IsUTF_c Dst_t, typename Alloc_t=std::allocator<Dst_t>>
+constexpr std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> Latin1ConvertTo(std::string_view src,
+                                                                                 const Alloc_t& alloc = Alloc_t{}) {
+    std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> result(alloc);
+    const size_t length = Latin1EncodedLength<Dst_t>(src);
+    result.resize_and_overwrite(length, [src, length](Dst_t* out, size_t) {
+        detail::TranscodeFromLatin1(src, out);
+        return length;
+    });
+    return result;
+}
+
+
+// Sized by the number of code units, which bounds the number of code points, and shrunk to fit afterwards.
+template <IsUTF_c Src_t, typename Alloc_t=std::allocator<char>>
+constexpr std::basic_string<char, std::char_traits<char>, Alloc_t> UTFConvertToLatin1(std::basic_string_view<Src_t> src,
+                                                                                  char replacement = LATIN1_REPLACEMENT,
+                                                                                  const Alloc_t& alloc = Alloc_t{}) {
+    std::basic_string<char, std::char_traits<char>, Alloc_t> result(alloc);
+    result.resize_and_overwrite(src.size(), [src, replacement](char* out, size_t) {
+        return static_cast<size_t>(detail::TranscodeToLatin1(src, out, replacement) - out);
+    });
+    result.shrink_to_fit();
+    return result;
+}
+
+
+constexpr std::u8string latin1_to_8(std::string_view sv)   { return Latin1ConvertTo<char8_t>(sv); }
+constexpr std::u16string latin1_to_16(std::string_view sv) { return Latin1ConvertTo<char16_t>(sv); }
+constexpr std::u32string latin1_to_32(std::string_view sv) { return Latin1ConvertTo<char32_t>(sv); }
+
+constexpr std::string utf8_to_latin1(std::u8string_view sv, char replacement = LATIN1_REPLACEMENT) {
+    return UTFConvertToLatin1<char8_t>(sv, replacement);
+}
+constexpr std::string utf16_to_latin1(std::u16string_view sv, char replacement = LATIN1_REPLACEMENT) {
+    return UTFConvertToLatin1<char16_t>(sv, replacement);
+}
+constexpr std::string utf32_to_latin1(std::u32string_view sv, char replacement = LATIN1_REPLACEMENT) {
+    return UTFConvertToLatin1<char32_t>(sv, replacement);
+}
+
+
+} // namespace utfcpp
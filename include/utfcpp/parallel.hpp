@@ -0,0 +1,86 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/utility.hpp"
+
+
+namespace utfcpp {
+
+
+// Inputs are only split into chunks of at least this many code units; smaller ones are converted serially.
+constexpr size_t PARALLEL_MIN_CHUNK {size_t{1} << 18};
+
+
+namespace detail {
+
+
+// Runs f(i) for every chunk index in [0, chunk_count), the first chunk on the calling thread.
+template <typename F>
+void ForEachChunk(size_t chunk_count, F f) {
+    std::vector<std::jthread> workers{};
+    workers.reserve(chunk_count - 1);
+    for (size_t i = 1; i < chunk_count; ++i) { workers.emplace_back(f, i); }
+    f(size_t{0});
+}
+
+
+} // namespace detail
+
+
+// Same result as UTFConvertTo, with the work spread over up to thread_count threads (0: one per core).
+// The source is split at code point boundaries; chunk lengths are counted in parallel, and every thread
+// then writes its chunk straight into its slice of the output.
+template <IsUTF_c Src_t, IsUTF_c Dst_t, typename Alloc_t=std::allocator<Dst_t>>
+std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> UTFConvertToParallel(std::basic_string_view<Src_t> src,
+                                                                              size_t thread_count = 0,
+                                                                              const Alloc_t& alloc = Alloc_t{}) {
+    if (!thread_count) { thread_count = std::max(1u, std::thread::hardware_concurrency()); }
+    const size_t chunk_count = std::min(thread_count, src.size() / PARALLEL_MIN_CHUNK);
+    if (chunk_count <= 1) { return UTFConvertTo<Src_t, Dst_t, UTFInputIterator, Alloc_t>(src, alloc); }
+
+    std::vector<size_t> bounds(chunk_count + 1, src.size());
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunk_count; ++i) {
+        bounds[i] = detail::SafeSplit(src, src.size() / chunk_count * i);
+    }
+    auto chunk = [&src, &bounds](size_t i) { return src.substr(bounds[i], bounds[i + 1] - bounds[i]); };
+
+    // offsets[i + 1] holds the length of chunk i until the prefix sum turns it into an end offset
+    std::vector<size_t> offsets(chunk_count + 1, 0);
+    detail::ForEachChunk(chunk_count, [&](size_t i) { offsets[i + 1] = EncodedLength<Dst_t, Src_t>(chunk(i)); });
+    for (size_t i = 1; i <= chunk_count; ++i) { offsets[i] += offsets[i - 1]; }
+
+    std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> result(alloc);
+    result.resize_and_overwrite(offsets.back(), [&](Dst_t* out, size_t) {
+        detail::ForEachChunk(chunk_count, [&](size_t i) {
+            detail::Transcode<Src_t, Dst_t>(chunk(i), out + offsets[i], out + offsets[i + 1]);
+        });
+        return offsets.back();
+    });
+    return result;
+}
+
+
+} // namespace utfcpp
@@ -0,0 +1,400 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+/***
+ * Instruction set selection
+ *
+ * Vector kernels are chosen at compile time from the target flags (-mssse3, -mavx2, /arch:AVX2, ...);
+ * without SSSE3 the lookup table kernels fall back to scalar code.
+ * Define UTFCPP_NO_SIMD to force the portable scalar kernels.
+ */
+#if !defined(UTFCPP_NO_SIMD)
+#  if defined(__AVX2__)
+#    define UTFCPP_AVX2 1
+#  endif
+#  if defined(__SSSE3__) || defined(__AVX__)
+#    define UTFCPP_SSSE3 1
+#  endif
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define UTFCPP_SSE2 1
+#  endif
+#endif
+
+#if defined(UTFCPP_AVX2) || defined(UTFCPP_SSSE3) || defined(UTFCPP_SSE2)
+#include <immintrin.h>
+#endif
+
+// Kernels that must not be inlined into callers holding short constant arrays, where GCC warns about the
+// wide loads it cannot prove unreachable.
+#if defined(_MSC_VER)
+#  define UTFCPP_NOINLINE __declspec(noinline)
+#else
+#  define UTFCPP_NOINLINE __attribute__((noinline))
+#endif
+
+#include "utfcpp/core.hpp"
+
+
+namespace utfcpp {
+
+
+// Largest number of bytes inspected by one step of the ASCII kernels.
+constexpr size_t ASCII_BLOCK_SIZE {64};
+
+
+namespace detail {
+
+
+constexpr size_t AsciiPrefixLengthScalar(const char8_t* first, size_t size) noexcept {
+    size_t i = 0;
+    while (i < size && first[i] < 0x80) { ++i; }
+    return i;
+}
+
+
+// Eight bytes at a time through a general purpose register.
+inline size_t AsciiPrefixLengthWord(const char8_t* first, size_t size) noexcept {
+    size_t i = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word{};
+            std::memcpy(&word, first + i, sizeof(word));
+            const uint64_t high_bits = word & 0x8080808080808080ull;
+            if (high_bits) { return i + (std::countr_zero(high_bits) >> 3); }
+        }
+    }
+    return i + AsciiPrefixLengthScalar(first + i, size - i);
+}
+
+
+#if defined(UTFCPP_AVX2)
+UTFCPP_NOINLINE inline size_t AsciiPrefixLengthVector(const char8_t* first, size_t size) noexcept {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i + 32));
+        if (_mm256_movemask_epi8(_mm256_or_si256(lo, hi))) {
+            const uint32_t lo_mask = static_cast<uint32_t>(_mm256_movemask_epi8(lo));
+            if (lo_mask) { return i + std::countr_zero(lo_mask); }
+            return i + 32 + std::countr_zero(static_cast<uint32_t>(_mm256_movemask_epi8(hi)));
+        }
+    }
+    if (i + 32 <= size) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(block));
+        if (mask) { return i + std::countr_zero(mask); }
+        i += 32;
+    }
+    return i + AsciiPrefixLengthWord(first + i, size - i);
+}
+#elif defined(UTFCPP_SSE2)
+UTFCPP_NOINLINE inline size_t AsciiPrefixLengthVector(const char8_t* first, size_t size) noexcept {
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 16));
+        const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 32));
+        const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 48));
+        const __m128i any = _mm_or_si128(_mm_or_si128(b0, b1), _mm_or_si128(b2, b3));
+        if (_mm_movemask_epi8(any)) {
+            const uint64_t mask = static_cast<uint64_t>(_mm_movemask_epi8(b0))         |
+                                  static_cast<uint64_t>(_mm_movemask_epi8(b1)) << 16   |
+                                  static_cast<uint64_t>(_mm_movemask_epi8(b2)) << 32   |
+                                  static_cast<uint64_t>(_mm_movemask_epi8(b3)) << 48;
+            return i + std::countr_zero(mask);
+        }
+    }
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(block));
+        if (mask) { return i + std::countr_zero(mask); }
+    }
+    return i + AsciiPrefixLengthWord(first + i, size - i);
+}
+#else
+UTFCPP_NOINLINE inline size_t AsciiPrefixLengthVector(const char8_t* first, size_t size) noexcept {
+    return AsciiPrefixLengthWord(first, size);
+}
+#endif
+
+
+// Counts the bytes in [low, high]. Vector kernels flip the top bit so that signed comparisons order bytes
+// as unsigned ones.
+constexpr size_t CountBytesInRangeScalar(const char8_t* first, size_t size, char8_t low, char8_t high) noexcept {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) { count += first[i] >= low && first[i] <= high; }
+    return count;
+}
+
+
+#if defined(UTFCPP_AVX2)
+inline size_t CountBytesInRangeVector(const char8_t* first, size_t size, char8_t low, char8_t high) noexcept {
+    const __m256i flip = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i min = _mm256_set1_epi8(static_cast<char>(low ^ 0x80));
+    const __m256i max = _mm256_set1_epi8(static_cast<char>(high ^ 0x80));
+    size_t outside = 0;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i block = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)), flip);
+        const __m256i out = _mm256_or_si256(_mm256_cmpgt_epi8(min, block), _mm256_cmpgt_epi8(block, max));
+        outside += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(out)));
+    }
+    return i - outside + CountBytesInRangeScalar(first + i, size - i, low, high);
+}
+#elif defined(UTFCPP_SSE2)
+inline size_t CountBytesInRangeVector(const char8_t* first, size_t size, char8_t low, char8_t high) noexcept {
+    const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i min = _mm_set1_epi8(static_cast<char>(low ^ 0x80));
+    const __m128i max = _mm_set1_epi8(static_cast<char>(high ^ 0x80));
+    size_t outside = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i block = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)), flip);
+        const __m128i out = _mm_or_si128(_mm_cmpgt_epi8(min, block), _mm_cmpgt_epi8(block, max));
+        outside += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(out)));
+    }
+    return i - outside + CountBytesInRangeScalar(first + i, size - i, low, high);
+}
+#else
+inline size_t CountBytesInRangeVector(const char8_t* first, size_t size, char8_t low, char8_t high) noexcept {
+    return CountBytesInRangeScalar(first, size, low, high);
+}
+#endif
+
+
+constexpr size_t CountBytesInRange(std::u8string_view utf8str, char8_t low, char8_t high) noexcept {
+    if consteval {
+        return CountBytesInRangeScalar(utf8str.data(), utf8str.size(), low, high);
+    } else {
+        return CountBytesInRangeVector(utf8str.data(), utf8str.size(), low, high);
+    }
+}
+
+
+/***
+ * Register wrappers used by the lookup table kernels
+ */
+#if defined(UTFCPP_AVX2)
+struct VectorAVX2 {
+    using reg = __m256i;
+    static constexpr size_t width = 32;
+
+    static reg load(const char8_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static reg table(const uint8_t (&t)[16]) noexcept {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t)));
+    }
+    static reg table32(const uint8_t (&t)[32]) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t)); }
+    static reg zero() noexcept { return _mm256_setzero_si256(); }
+    static reg splat(uint8_t v) noexcept { return _mm256_set1_epi8(static_cast<char>(v)); }
+    static reg bit_or(reg a, reg b) noexcept { return _mm256_or_si256(a, b); }
+    static reg bit_and(reg a, reg b) noexcept { return _mm256_and_si256(a, b); }
+    static reg bit_xor(reg a, reg b) noexcept { return _mm256_xor_si256(a, b); }
+    static reg high_nibbles(reg v) noexcept { return _mm256_and_si256(_mm256_srli_epi16(v, 4), splat(0x0f)); }
+    static reg low_nibbles(reg v) noexcept { return _mm256_and_si256(v, splat(0x0f)); }
+    static reg lookup(reg tbl, reg idx) noexcept { return _mm256_shuffle_epi8(tbl, idx); }
+    static reg saturating_sub(reg a, reg b) noexcept { return _mm256_subs_epu8(a, b); }
+    static bool is_ascii(reg v) noexcept { return _mm256_movemask_epi8(v) == 0; }
+    static bool is_zero(reg v) noexcept { return _mm256_testz_si256(v, v); }
+    template <int N> static reg prev(reg input, reg prev_input) noexcept {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+    }
+};
+#endif
+
+#if defined(UTFCPP_SSSE3)
+struct VectorSSSE3 {
+    using reg = __m128i;
+    static constexpr size_t width = 16;
+
+    static reg load(const char8_t* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static reg table(const uint8_t (&t)[16]) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(t)); }
+    static reg table32(const uint8_t (&t)[32]) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + 16)); }
+    static reg zero() noexcept { return _mm_setzero_si128(); }
+    static reg splat(uint8_t v) noexcept { return _mm_set1_epi8(static_cast<char>(v)); }
+    static reg bit_or(reg a, reg b) noexcept { return _mm_or_si128(a, b); }
+    static reg bit_and(reg a, reg b) noexcept { return _mm_and_si128(a, b); }
+    static reg bit_xor(reg a, reg b) noexcept { return _mm_xor_si128(a, b); }
+    static reg high_nibbles(reg v) noexcept { return _mm_and_si128(_mm_srli_epi16(v, 4), splat(0x0f)); }
+    static reg low_nibbles(reg v) noexcept { return _mm_and_si128(v, splat(0x0f)); }
+    static reg lookup(reg tbl, reg idx) noexcept { return _mm_shuffle_epi8(tbl, idx); }
+    static reg saturating_sub(reg a, reg b) noexcept { return _mm_subs_epu8(a, b); }
+    static bool is_ascii(reg v) noexcept { return _mm_movemask_epi8(v) == 0; }
+    static bool is_zero(reg v) noexcept { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero())) == 0xffff; }
+    template <int N> static reg prev(reg input, reg prev_input) noexcept { return _mm_alignr_epi8(input, prev_input, 16 - N); }
+};
+#endif
+
+
+// Start of the code point that contains, or begins at, pos. Everything before pos must be valid utf-8.
+constexpr size_t CodePointBoundaryUTF8(const char8_t* data, size_t pos) noexcept {
+    for (size_t back = 1; back <= 3 && back <= pos; ++back) {
+        if (!IsTrailUTF8(data[pos - back])) { return pos - back; }
+    }
+    return pos;
+}
+
+
+// Lookup table validation after Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+// Each byte is classified by the nibbles of itself and its predecessor; the three lookups only agree on an
+// error bit for invalid pairs, and a separate check makes sure 3 and 4 byte sequences have their trail bytes.
+// Returns a code point boundary up to which data is valid; the remainder is left for the scalar decoder.
+template <typename V>
+size_t ValidUTF8PrefixLookup(const char8_t* data, size_t size) noexcept {
+    using reg = typename V::reg;
+    constexpr uint8_t TOO_SHORT      = 1 << 0; // 11______ 0_______ or 11______ 11______
+    constexpr uint8_t TOO_LONG       = 1 << 1; // 0_______ 10______
+    constexpr uint8_t OVERLONG_3     = 1 << 2; // 11100000 100_____
+    constexpr uint8_t TOO_LARGE      = 1 << 3; // 11110100 1001____ and above
+    constexpr uint8_t SURROGATE      = 1 << 4; // 11101101 101_____
+    constexpr uint8_t OVERLONG_2     = 1 << 5; // 1100000_ 10______
+    constexpr uint8_t TOO_LARGE_1000 = 1 << 6; // 11110101 1000____ and above
+    constexpr uint8_t OVERLONG_4     = 1 << 6; // 11110000 1000____
+    constexpr uint8_t TWO_CONTS      = 1 << 7; // 10______ 10______
+    constexpr uint8_t CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    static constexpr uint8_t byte_1_high[16] = {
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        TOO_SHORT | OVERLONG_2,
+        TOO_SHORT,
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+    };
+    static constexpr uint8_t byte_1_low[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+        CARRY | OVERLONG_2,
+        CARRY,
+        CARRY,
+        CARRY | TOO_LARGE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000
+    };
+    static constexpr uint8_t byte_2_high[16] = {
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE  | TOO_LARGE,
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+    };
+    // A block ending in the lead of a sequence that continues into the next block
+    static constexpr uint8_t incomplete_max[32] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 - 1, 0xe0 - 1, 0xc0 - 1
+    };
+
+    const reg byte_1_high_tbl = V::table(byte_1_high);
+    const reg byte_1_low_tbl  = V::table(byte_1_low);
+    const reg byte_2_high_tbl = V::table(byte_2_high);
+    const reg max_value       = V::table32(incomplete_max);
+
+    reg prev_input = V::zero();
+    reg prev_incomplete = V::zero();
+    size_t i = 0;
+    for (; i + V::width <= size; i += V::width) {
+        const reg input = V::load(data + i);
+        reg error = V::zero();
+        if (!V::is_ascii(input)) {
+            const reg prev1 = V::template prev<1>(input, prev_input);
+            const reg special_cases = V::bit_and(V::bit_and(
+                V::lookup(byte_1_high_tbl, V::high_nibbles(prev1)),
+                V::lookup(byte_1_low_tbl, V::low_nibbles(prev1))),
+                V::lookup(byte_2_high_tbl, V::high_nibbles(input)));
+            const reg prev2 = V::template prev<2>(input, prev_input);
+            const reg prev3 = V::template prev<3>(input, prev_input);
+            const reg must_be_continuation = V::bit_and(V::bit_or(V::saturating_sub(prev2, V::splat(0xe0 - 0x80)),
+                                                                  V::saturating_sub(prev3, V::splat(0xf0 - 0x80))),
+                                                        V::splat(0x80));
+            error = V::bit_or(error, V::bit_xor(must_be_continuation, special_cases));
+            prev_incomplete = V::saturating_sub(input, max_value);
+        } else {
+            // Only an all ASCII block can leave a sequence from the previous block unterminated unnoticed
+            error = prev_incomplete;
+            prev_incomplete = V::zero();
+        }
+        if (!V::is_zero(error)) { break; }
+        prev_input = input;
+    }
+    return CodePointBoundaryUTF8(data, i);
+}
+
+
+inline size_t ValidUTF8PrefixVector([[maybe_unused]] const char8_t* data, [[maybe_unused]] size_t size) noexcept {
+#if defined(UTFCPP_AVX2)
+    return ValidUTF8PrefixLookup<VectorAVX2>(data, size);
+#elif defined(UTFCPP_SSSE3)
+    return ValidUTF8PrefixLookup<VectorSSSE3>(data, size);
+#else
+    return 0;
+#endif
+}
+
+
+// A code point boundary up to which utf8str is known to be valid utf-8; not necessarily the longest such.
+constexpr size_t ValidUTF8Prefix(std::u8string_view utf8str) noexcept {
+    if consteval {
+        return 0;
+    } else {
+        return ValidUTF8PrefixVector(utf8str.data(), utf8str.size());
+    }
+}
+
+
+} // namespace detail
+
+
+// Number of leading code units of utf8str that are ASCII (< 0x80). Input shorter than a vector is scanned
+// inline; the vector kernel is called out of line.
+constexpr size_t AsciiPrefixLength(std::u8string_view utf8str) noexcept {
+    if consteval {
+        return detail::AsciiPrefixLengthScalar(utf8str.data(), utf8str.size());
+    } else {
+        if (utf8str.size() < 16) { return detail::AsciiPrefixLengthScalar(utf8str.data(), utf8str.size()); }
+        return detail::AsciiPrefixLengthVector(utf8str.data(), utf8str.size());
+    }
+}
+
+
+// Number of code units of utf8str that are not trail bytes; the code point count of valid utf-8.
+constexpr size_t CountLeadBytesUTF8(std::u8string_view utf8str) noexcept {
+    return utf8str.size() - detail::CountBytesInRange(utf8str, 0x80, 0xbf);
+}
+
+
+// Number of code units of utf8str that lead 4 byte sequences (>= 0xf0).
+constexpr size_t CountFourByteLeadsUTF8(std::u8string_view utf8str) noexcept {
+    return detail::CountBytesInRange(utf8str, 0xf0, 0xff);
+}
+
+
+} // namespace utfcpp
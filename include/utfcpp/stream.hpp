@@ -0,0 +1,174 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "utfcpp/concepts.hpp"
+#include "utfcpp/core.hpp"
+#include "utfcpp/decode_encode.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/utility.hpp"
+
+
+namespace utfcpp {
+
+
+namespace detail {
+
+
+// Number of code units at the end of src that start a code point more input could complete.
+template <IsUTF_c Src_t>
+constexpr size_t IncompleteTailLength(std::basic_string_view<Src_t> src) noexcept {
+    if constexpr (std::is_same_v<Src_t, char8_t>) {
+        for (size_t back = 1; back <= 3 && back <= src.size(); ++back) {
+            const char8_t ch = src[src.size() - back];
+            if (!IsTrailUTF8(ch)) { return SequenceLength(ch) > back ? back : 0; }
+        }
+        return 0;
+    } else if constexpr (std::is_same_v<Src_t, char16_t>) {
+        return !src.empty() && IsLeadSurrogateUTF16(src.back()) ? 1 : 0;
+    } else {
+        return 0;
+    }
+}
+
+
+} // namespace detail
+
+
+/***
+ * Stateful transcoder for input that arrives in chunks
+ *
+ * A code point split across chunks is held back (up to 3 utf-8 bytes or a lead surrogate) and completed
+ * by the next call, so the concatenated output equals that of UTFConvertTo over the concatenated input.
+ * Output goes into caller buffers; when one fills up, Transcode stops with NOT_ENOUGH_ROOM and the caller
+ * resubmits the rest of the chunk (src.substr(consumed)) with a fresh buffer. Buffers must have room for
+ * at least one encoded code point (4 utf-8 or 2 utf-16 code units) for every call to make progress.
+ */
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+class StreamTranscoder {
+public:
+    // Code units that can be held back between calls
+    static constexpr size_t MAX_PENDING = std::is_same_v<Src_t, char8_t> ? 3 : (std::is_same_v<Src_t, char16_t> ? 1 : 0);
+
+    constexpr StreamTranscoder() noexcept = default;
+
+    // Converts as much of src as fits into dst. Code units held back at the end of src count as consumed.
+    constexpr TranscodeResult Transcode(std::basic_string_view<Src_t> src, std::span<Dst_t> dst) noexcept {
+        TranscodeResult result{};
+        Dst_t* out = dst.data();
+        Dst_t* const out_end = dst.data() + dst.size();
+
+        // Finish the code point held back from the previous call first
+        while (pending_size) {
+            std::array<Src_t, 2 * MAX_PENDING> window{};
+            const size_t held = std::min(pending_size, MAX_PENDING);
+            const size_t borrowed = std::min(src.size(), MAX_PENDING);
+            for (size_t i = 0; i < held; ++i) { window[i] = pending[i]; }
+            for (size_t i = 0; i < borrowed; ++i) { window[held + i] = src[i]; }
+            const std::basic_string_view<Src_t> window_view{window.data(), held + borrowed};
+            if (detail::IncompleteTailLength(window_view) == window_view.size()) {
+                // Still incomplete; all of src fits in the window
+                append_pending(src);
+                result.consumed += src.size();
+                result.produced = static_cast<size_t>(out - dst.data());
+                return result;
+            }
+            const DecodeData data = detail::DecodeOne(window_view);
+            if (detail::EncodedLengthOne<Dst_t>(data.code_point) > static_cast<size_t>(out_end - out)) {
+                result.error_code = UTF_ERROR::NOT_ENOUGH_ROOM;
+                result.produced = static_cast<size_t>(out - dst.data());
+                return result;
+            }
+            out = detail::WriteCodePoint(data.code_point, out);
+            if (data.consumed < pending_size) {
+                drop_pending(data.consumed);
+            } else {
+                const size_t taken = data.consumed - pending_size;
+                pending_size = 0;
+                src.remove_prefix(taken);
+                result.consumed += taken;
+            }
+        }
+
+        const size_t tail = detail::IncompleteTailLength(src);
+        const std::basic_string_view<Src_t> body = src.substr(0, src.size() - tail);
+
+        const TranscodeResult converted = detail::TranscodeInto<Src_t, Dst_t>(body, out, out_end);
+        out += converted.produced;
+        size_t pos = converted.consumed;
+        result.error_code = converted.error_code;
+        if (pos == body.size() && tail) {
+            append_pending(src.substr(pos));
+            pos = src.size();
+        }
+        result.consumed += pos;
+        result.produced = static_cast<size_t>(out - dst.data());
+        return result;
+    }
+
+    // Flushes code units held back at the end of the stream; each becomes a REPLACEMENT_CHARACTER.
+    constexpr TranscodeResult Finish(std::span<Dst_t> dst) noexcept {
+        TranscodeResult result{};
+        Dst_t* out = dst.data();
+        Dst_t* const out_end = dst.data() + dst.size();
+        while (pending_size) {
+            const DecodeData data = detail::DecodeOne(pending_view());
+            if (detail::EncodedLengthOne<Dst_t>(data.code_point) > static_cast<size_t>(out_end - out)) {
+                result.error_code = UTF_ERROR::NOT_ENOUGH_ROOM;
+                break;
+            }
+            out = detail::WriteCodePoint(data.code_point, out);
+            drop_pending(data.consumed);
+        }
+        result.produced = static_cast<size_t>(out - dst.data());
+        return result;
+    }
+
+    // Code units held back for the next call
+    constexpr std::basic_string_view<Src_t> Pending() const noexcept { return pending_view(); }
+
+    constexpr void Reset() noexcept { pending_size = 0; }
+
+private:
+    constexpr std::basic_string_view<Src_t> pending_view() const noexcept { return {pending.data(), pending_size}; }
+
+    // Element loops with counts clamped to MAX_PENDING, so that the compiler can see they stay in bounds.
+    constexpr void append_pending(std::basic_string_view<Src_t> src) noexcept {
+        const size_t count = std::min(src.size(), MAX_PENDING - std::min(pending_size, MAX_PENDING));
+        for (size_t i = 0; i < count; ++i) { pending[pending_size + i] = src[i]; }
+        pending_size += count;
+    }
+
+    // Shifts the held code units down in place, front to back.
+    constexpr void drop_pending(size_t count) noexcept {
+        const size_t size = std::min(pending_size, MAX_PENDING);
+        for (size_t i = 0; i + count < size; ++i) { pending[i] = pending[i + count]; }
+        pending_size = count < size ? size - count : 0;
+    }
+
+    std::array<Src_t, MAX_PENDING> pending{};
+    size_t pending_size{0};
+};
+
+
+} // namespace utfcpp
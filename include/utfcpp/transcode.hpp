@@ -0,0 +1,495 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include "utfcpp/core.hpp"
+#include "utfcpp/decode_encode.hpp"
+#include "utfcpp/simd.hpp"
+
+
+/***
+ * Bulk transcoding kernels
+ *
+ * Each kernel converts a whole buffer with the same results as decoding one code point at a time
+ * (invalid input becomes REPLACEMENT_CHARACTER). The output range [out, out_end) must be sized
+ * exactly by EncodedLength; vector stores that would run past out_end fall back to scalar code.
+ */
+namespace utfcpp::detail {
+
+
+/***
+ * Lane helpers
+ */
+#if defined(UTFCPP_SSE2)
+// Mask with two bits per 16 bit lane of block for which (lane & mask) == value.
+inline uint32_t MatchLanes16(__m128i block, uint16_t mask, uint16_t value) noexcept {
+    const __m128i masked = _mm_and_si128(block, _mm_set1_epi16(static_cast<short>(mask)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(masked, _mm_set1_epi16(static_cast<short>(value)))));
+}
+
+
+// Stores 8 16 bit lanes as utf-16 or utf-32 code units.
+template <typename Dst_t>
+inline void StoreLanes16(__m128i lanes, Dst_t* out) noexcept {
+    if constexpr (std::is_same_v<Dst_t, char16_t>) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lanes);
+    } else {
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),     _mm_unpacklo_epi16(lanes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lanes, zero));
+    }
+}
+
+
+// Widens 16 bytes to 16 utf-16 or utf-32 code units.
+template <typename Dst_t>
+inline void WidenASCII16(__m128i block, Dst_t* out) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    StoreLanes16(_mm_unpacklo_epi8(block, zero), out);
+    StoreLanes16(_mm_unpackhi_epi8(block, zero), out + 8);
+}
+
+
+// Decodes the 2 byte sequences lined up at the start of block; returns how many there were (up to 8).
+inline size_t DecodeTwoByteLanes(__m128i block, __m128i& decoded) noexcept {
+    const __m128i lead_and_trail = _mm_and_si128(block, _mm_set1_epi16(static_cast<short>(0xc0e0)));
+    const __m128i is_pair  = _mm_cmpeq_epi16(lead_and_trail, _mm_set1_epi16(static_cast<short>(0x80c0)));
+    const __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(block, _mm_set1_epi16(0x001e)), _mm_setzero_si128());
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_andnot_si128(overlong, is_pair)));
+    decoded = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(block, _mm_set1_epi16(0x1f)), 6),
+                           _mm_and_si128(_mm_srli_epi16(block, 8), _mm_set1_epi16(0x3f)));
+    return static_cast<size_t>(std::countr_one(mask)) / 2;
+}
+
+
+// Combines the surrogate pairs lined up at the start of block (and selected by lanes); returns how many (up to 4).
+inline size_t DecodeSurrogatePairLanes(__m128i block, uint32_t lanes, __m128i& code_points) noexcept {
+    const __m128i masked = _mm_and_si128(block, _mm_set1_epi32(static_cast<int>(0xfc00fc00)));
+    const __m128i is_pair = _mm_cmpeq_epi32(masked, _mm_set1_epi32(static_cast<int>(0xdc00d800)));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(is_pair)) & lanes;
+    const __m128i lead  = _mm_and_si128(block, _mm_set1_epi32(0x3ff));
+    const __m128i trail = _mm_and_si128(_mm_srli_epi32(block, 16), _mm_set1_epi32(0x3ff));
+    code_points = _mm_add_epi32(_mm_or_si128(_mm_slli_epi32(lead, 10), trail), _mm_set1_epi32(0x10000));
+    return static_cast<size_t>(std::countr_one(mask)) / 4;
+}
+
+
+// Encodes the leading code units of block below 0x800 (and not ASCII) as 2 byte sequences; returns how many.
+inline size_t EncodeTwoByteLanes(__m128i block, uint32_t two_byte_mask, char8_t* out) noexcept {
+    const size_t count = static_cast<size_t>(std::countr_one(two_byte_mask)) / 2;
+    if (count) {
+        const __m128i lead  = _mm_or_si128(_mm_srli_epi16(block, 6), _mm_set1_epi16(0xc0));
+        const __m128i trail = _mm_or_si128(_mm_and_si128(block, _mm_set1_epi16(0x3f)), _mm_set1_epi16(0x80));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(lead, _mm_slli_epi16(trail, 8)));
+    }
+    return count;
+}
+
+
+// Encodes 4 supplementary code points as 4 byte sequences (16 bytes).
+inline void EncodeFourByteLanes(__m128i code_points, char8_t* out) noexcept {
+    const __m128i six_bits = _mm_set1_epi32(0x3f);
+    const __m128i b0 = _mm_or_si128(_mm_srli_epi32(code_points, 18), _mm_set1_epi32(0xf0));
+    const __m128i b1 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(code_points, 12), six_bits), _mm_set1_epi32(0x80));
+    const __m128i b2 = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(code_points, 6), six_bits), _mm_set1_epi32(0x80));
+    const __m128i b3 = _mm_or_si128(_mm_and_si128(code_points, six_bits), _mm_set1_epi32(0x80));
+    const __m128i encoded = _mm_or_si128(_mm_or_si128(b0, _mm_slli_epi32(b1, 8)),
+                                         _mm_or_si128(_mm_slli_epi32(b2, 16), _mm_slli_epi32(b3, 24)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encoded);
+}
+
+
+// All ones in each 32 bit lane of block that is not a valid code point.
+inline __m128i InvalidLanes32(__m128i block) noexcept {
+    // No unsigned compare in SSE2; flip the sign bits and compare signed
+    const __m128i sign = _mm_set1_epi32(static_cast<int>(0x80000000));
+    const __m128i too_large = _mm_cmpgt_epi32(_mm_xor_si128(block, sign),
+                                              _mm_xor_si128(_mm_set1_epi32(static_cast<int>(CODE_POINT_MAX)), sign));
+    const __m128i surrogate = _mm_cmpeq_epi32(_mm_and_si128(block, _mm_set1_epi32(static_cast<int>(0xfffff800))),
+                                              _mm_set1_epi32(0xd800));
+    return _mm_or_si128(too_large, surrogate);
+}
+
+
+// All ones in each 32 bit lane of block holding a valid code point from the BMP.
+inline __m128i BMPLanes32(__m128i block) noexcept {
+    const __m128i in_bmp = _mm_cmpeq_epi32(_mm_and_si128(block, _mm_set1_epi32(static_cast<int>(0xffff0000))),
+                                           _mm_setzero_si128());
+    const __m128i surrogate = _mm_cmpeq_epi32(_mm_and_si128(block, _mm_set1_epi32(static_cast<int>(0xfffff800))),
+                                              _mm_set1_epi32(0xd800));
+    return _mm_andnot_si128(surrogate, in_bmp);
+}
+
+
+// Narrows 8 utf-32 code units known to be below 0x10000 to 16 bit lanes.
+inline __m128i NarrowLanes32(__m128i lo, __m128i hi) noexcept {
+    // packs saturates signed values; bias into the signed range and back
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(lo, bias32), _mm_sub_epi32(hi, bias32));
+    return _mm_add_epi16(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+#endif
+
+
+#if defined(UTFCPP_SSSE3)
+// Decodes the 3 byte sequences lined up at the start of block; returns how many there were (up to 5).
+inline size_t DecodeThreeByteLanes(__m128i block, __m128i& decoded) noexcept {
+    const __m128i lead   = _mm_shuffle_epi8(block, _mm_setr_epi8(0, -1, 3, -1, 6, -1,  9, -1, 12, -1, -1, -1, -1, -1, -1, -1));
+    const __m128i trail1 = _mm_shuffle_epi8(block, _mm_setr_epi8(1, -1, 4, -1, 7, -1, 10, -1, 13, -1, -1, -1, -1, -1, -1, -1));
+    const __m128i trail2 = _mm_shuffle_epi8(block, _mm_setr_epi8(2, -1, 5, -1, 8, -1, 11, -1, 14, -1, -1, -1, -1, -1, -1, -1));
+    const __m128i trail_mask = _mm_set1_epi16(0xc0);
+    const __m128i trail_bits = _mm_set1_epi16(0x80);
+    decoded = _mm_or_si128(_mm_or_si128(
+        _mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(0x0f)), 12),
+        _mm_slli_epi16(_mm_and_si128(trail1, _mm_set1_epi16(0x3f)), 6)),
+        _mm_and_si128(trail2, _mm_set1_epi16(0x3f)));
+    const __m128i top_bits = _mm_and_si128(decoded, _mm_set1_epi16(static_cast<short>(0xf800)));
+    __m128i ok = _mm_cmpeq_epi16(_mm_and_si128(lead, _mm_set1_epi16(0xf0)), _mm_set1_epi16(0xe0));
+    ok = _mm_and_si128(ok, _mm_cmpeq_epi16(_mm_and_si128(trail1, trail_mask), trail_bits));
+    ok = _mm_and_si128(ok, _mm_cmpeq_epi16(_mm_and_si128(trail2, trail_mask), trail_bits));
+    // Overlong (below 0x800) and surrogate code points are left to the scalar decoder
+    ok = _mm_andnot_si128(_mm_cmpeq_epi16(top_bits, _mm_setzero_si128()), ok);
+    ok = _mm_andnot_si128(_mm_cmpeq_epi16(top_bits, _mm_set1_epi16(static_cast<short>(0xd800))), ok);
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(ok)) & 0x3ff;
+    return static_cast<size_t>(std::countr_one(mask)) / 2;
+}
+
+
+// Encodes the leading BMP code units of block at or above 0x800 as 3 byte sequences; returns how many.
+// Writes up to 28 bytes.
+inline size_t EncodeThreeByteLanes(__m128i block, uint32_t three_byte_mask, char8_t* out) noexcept {
+    const size_t count = static_cast<size_t>(std::countr_one(three_byte_mask)) / 2;
+    if (count) {
+        const __m128i six_bits = _mm_set1_epi16(0x3f);
+        const __m128i b0 = _mm_or_si128(_mm_srli_epi16(block, 12), _mm_set1_epi16(0xe0));
+        const __m128i b1 = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(block, 6), six_bits), _mm_set1_epi16(0x80));
+        const __m128i b2 = _mm_or_si128(_mm_and_si128(block, six_bits), _mm_set1_epi16(0x80));
+        const __m128i b01 = _mm_or_si128(b0, _mm_slli_epi16(b1, 8));
+        // [b0 b1 b2 0] per code unit, then squeezed to 12 bytes per four code units
+        const __m128i compact = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),      _mm_shuffle_epi8(_mm_unpacklo_epi16(b01, b2), compact));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_shuffle_epi8(_mm_unpackhi_epi16(b01, b2), compact));
+    }
+    return count;
+}
+#endif
+
+
+#if defined(UTFCPP_SSE2)
+// Encodes the leading utf-16 code units of block (restricted to lanes, two bits each) as utf-8.
+// Returns the number of code units consumed; 0 when the first one needs the scalar path.
+inline size_t EncodeUTF16Lanes(__m128i block, uint32_t lanes, char8_t*& out, const char8_t* out_end) noexcept {
+    const size_t room = static_cast<size_t>(out_end - out);
+    const uint32_t ascii_mask = MatchLanes16(block, 0xff80, 0x0000) & lanes;
+    if (ascii_mask & 0x3) {
+        if (room < 8) { return 0; }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(block, block));
+        const size_t ascii = static_cast<size_t>(std::countr_one(ascii_mask)) / 2;
+        out += ascii;
+        return ascii;
+    }
+    if (room < 28) { return 0; }
+    const uint32_t bmp_mask = MatchLanes16(block, 0xf800, 0x0000) & lanes;
+    if (const size_t two = EncodeTwoByteLanes(block, bmp_mask & ~ascii_mask, out)) {
+        out += 2 * two;
+        return two;
+    }
+#if defined(UTFCPP_SSSE3)
+    const uint32_t three_byte_mask = ~(bmp_mask | MatchLanes16(block, 0xf800, 0xd800)) & lanes;
+    if (const size_t three = EncodeThreeByteLanes(block, three_byte_mask, out)) {
+        out += 3 * three;
+        return three;
+    }
+#endif
+    __m128i code_points;
+    if (const size_t pairs = DecodeSurrogatePairLanes(block, lanes, code_points)) {
+        EncodeFourByteLanes(code_points, out);
+        out += 4 * pairs;
+        return 2 * pairs;
+    }
+    return 0;
+}
+#endif
+
+
+/***
+ * utf-8 source
+ */
+template <typename Dst_t>
+inline Dst_t* TranscodeFromUTF8(std::u8string_view src, Dst_t* out, [[maybe_unused]] Dst_t* const out_end) noexcept {
+    static_assert(std::is_same_v<Dst_t, char16_t> || std::is_same_v<Dst_t, char32_t>);
+    auto scalar_step = [](char32_t code_point, Dst_t* out) {
+        if constexpr (std::is_same_v<Dst_t, char16_t>) { return out + EncodeUTF16(code_point, out); }
+        else { *out = code_point; return out + 1; }
+    };
+    const char8_t* const data = src.data();
+    const size_t size = src.size();
+    size_t pos = 0;
+#if defined(UTFCPP_SSE2)
+    while (pos + 16 <= size) {
+#if defined(UTFCPP_AVX2)
+        if (pos + 32 <= size) {
+            const __m256i wide = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+            if (!_mm256_movemask_epi8(wide)) {
+                if constexpr (std::is_same_v<Dst_t, char16_t>) {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                                        _mm256_cvtepu8_epi16(_mm256_castsi256_si128(wide)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16),
+                                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(wide, 1)));
+                } else {
+                    for (size_t i = 0; i < 32; i += 8) {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                            _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + pos + i))));
+                    }
+                }
+                pos += 32;
+                out += 32;
+                continue;
+            }
+        }
+#endif
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const uint32_t non_ascii = static_cast<uint32_t>(_mm_movemask_epi8(block));
+        const size_t room = static_cast<size_t>(out_end - out);
+        if (!non_ascii) {
+            WidenASCII16(block, out);
+            pos += 16;
+            out += 16;
+            continue;
+        }
+        if (room >= 16) {
+            if (const size_t ascii = static_cast<size_t>(std::countr_zero(non_ascii))) {
+                WidenASCII16(block, out);
+                pos += ascii;
+                out += ascii;
+                continue;
+            }
+        }
+        if (room >= 8) {
+            __m128i decoded;
+            if (const size_t pairs = DecodeTwoByteLanes(block, decoded)) {
+                StoreLanes16(decoded, out);
+                pos += 2 * pairs;
+                out += pairs;
+                continue;
+            }
+#if defined(UTFCPP_SSSE3)
+            if (const size_t triples = DecodeThreeByteLanes(block, decoded)) {
+                StoreLanes16(decoded, out);
+                pos += 3 * triples;
+                out += triples;
+                continue;
+            }
+#endif
+        }
+        // 4 byte sequences, errors and mixed lanes: one code point at a time
+        const DecodeData data_cp = DecodeUTF8(src.substr(pos));
+        out = scalar_step(data_cp.code_point, out);
+        pos += data_cp.consumed;
+    }
+#endif
+    while (pos < size) {
+        const char8_t lead = data[pos];
+        if (lead < 0x80) {
+            *out++ = lead;
+            ++pos;
+            continue;
+        }
+        const DecodeData data_cp = DecodeUTF8(src.substr(pos));
+        out = scalar_step(data_cp.code_point, out);
+        pos += data_cp.consumed;
+    }
+    return out;
+}
+
+
+/***
+ * utf-16 source
+ */
+inline char8_t* TranscodeUTF16ToUTF8(std::u16string_view src, char8_t* out, [[maybe_unused]] char8_t* const out_end) noexcept {
+    const char16_t* const data = src.data();
+    const size_t size = src.size();
+    size_t pos = 0;
+#if defined(UTFCPP_SSE2)
+    while (pos + 8 <= size) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        if (MatchLanes16(block, 0xff80, 0x0000) == 0xffff && pos + 16 <= size) {
+            const __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 8));
+            if (MatchLanes16(next, 0xff80, 0x0000) == 0xffff) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(block, next));
+                pos += 16;
+                out += 16;
+                continue;
+            }
+        }
+        if (const size_t consumed = EncodeUTF16Lanes(block, 0xffff, out, out_end)) {
+            pos += consumed;
+            continue;
+        }
+        // Unpaired surrogates and mixed lanes: one code point at a time
+        const DecodeData data_cp = DecodeUTF16(src.substr(pos));
+        out += EncodeUTF8(data_cp.code_point, out);
+        pos += data_cp.consumed;
+    }
+#endif
+    while (pos < size) {
+        const char16_t unit = data[pos];
+        if (unit < 0x80) {
+            *out++ = static_cast<char8_t>(unit);
+            ++pos;
+            continue;
+        }
+        const DecodeData data_cp = DecodeUTF16(src.substr(pos));
+        out += EncodeUTF8(data_cp.code_point, out);
+        pos += data_cp.consumed;
+    }
+    return out;
+}
+
+
+inline char32_t* TranscodeUTF16ToUTF32(std::u16string_view src, char32_t* out, [[maybe_unused]] char32_t* const out_end) noexcept {
+    const size_t size = src.size();
+    size_t pos = 0;
+#if defined(UTFCPP_SSE2)
+    const char16_t* const data = src.data();
+    while (pos + 8 <= size) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const uint32_t surrogates = MatchLanes16(block, 0xf800, 0xd800);
+        const size_t room = static_cast<size_t>(out_end - out);
+        if (!surrogates) {
+            StoreLanes16(block, out);
+            pos += 8;
+            out += 8;
+            continue;
+        }
+        if (room >= 8) {
+            if (const size_t bmp = static_cast<size_t>(std::countr_zero(surrogates)) / 2) {
+                StoreLanes16(block, out);
+                pos += bmp;
+                out += bmp;
+                continue;
+            }
+        }
+        if (room >= 4) {
+            __m128i code_points;
+            if (const size_t pairs = DecodeSurrogatePairLanes(block, 0xffff, code_points)) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), code_points);
+                pos += 2 * pairs;
+                out += pairs;
+                continue;
+            }
+        }
+        // Unpaired surrogates: one code point at a time
+        const DecodeData data_cp = DecodeUTF16(src.substr(pos));
+        *out++ = data_cp.code_point;
+        pos += data_cp.consumed;
+    }
+#endif
+    while (pos < size) {
+        const DecodeData data_cp = DecodeUTF16(src.substr(pos));
+        *out++ = data_cp.code_point;
+        pos += data_cp.consumed;
+    }
+    return out;
+}
+
+
+/***
+ * utf-32 source
+ */
+// Length of the leading run of valid code points.
+inline size_t ValidUTF32PrefixLength(std::u32string_view src) noexcept {
+    const char32_t* const data = src.data();
+    const size_t size = src.size();
+    size_t pos = 0;
+#if defined(UTFCPP_SSE2)
+    for (; pos + 8 <= size; pos += 8) {
+        const __m128i lo = InvalidLanes32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)));
+        const __m128i hi = InvalidLanes32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 4)));
+        const uint32_t invalid = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi32(lo, hi)));
+        if (invalid) { return pos + std::countr_zero(invalid) / 2; }
+    }
+#endif
+    while (pos < size && is_code_point_valid(data[pos])) { ++pos; }
+    return pos;
+}
+
+
+template <typename Dst_t>
+inline Dst_t* TranscodeFromUTF32(std::u32string_view src, Dst_t* out, [[maybe_unused]] Dst_t* const out_end) noexcept {
+    static_assert(std::is_same_v<Dst_t, char8_t> || std::is_same_v<Dst_t, char16_t>);
+    auto scalar_step = [](char32_t code_point, Dst_t* out) {
+        if constexpr (std::is_same_v<Dst_t, char8_t>) { return out + EncodeUTF8(code_point, out); }
+        else { return out + EncodeUTF16(code_point, out); }
+    };
+    const char32_t* const data = src.data();
+    const size_t size = src.size();
+    size_t pos = 0;
+#if defined(UTFCPP_SSE2)
+    while (pos + 8 <= size) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 4));
+        // Two bits per code point, lined up with the 16 bit lanes after narrowing
+        const uint32_t lanes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi32(BMPLanes32(lo), BMPLanes32(hi))));
+        if (lanes & 0x3) {
+            const __m128i narrowed = NarrowLanes32(lo, hi);
+            if constexpr (std::is_same_v<Dst_t, char16_t>) {
+                const size_t bmp = static_cast<size_t>(std::countr_one(lanes)) / 2;
+                if (bmp == 8 || static_cast<size_t>(out_end - out) >= 8) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), narrowed);
+                    pos += bmp;
+                    out += bmp;
+                    continue;
+                }
+            } else {
+                if (const size_t consumed = EncodeUTF16Lanes(narrowed, lanes, out, out_end)) {
+                    pos += consumed;
+                    continue;
+                }
+            }
+        }
+        // Supplementary and invalid code points: one at a time
+        out = scalar_step(data[pos], out);
+        ++pos;
+    }
+#endif
+    for (; pos < size; ++pos) { out = scalar_step(data[pos], out); }
+    return out;
+}
+
+
+// Copies valid runs as they are and replaces invalid code points.
+inline char32_t* TranscodeUTF32ToUTF32(std::u32string_view src, char32_t* out) noexcept {
+    while (!src.empty()) {
+        const size_t valid = ValidUTF32PrefixLength(src);
+        std::memcpy(out, src.data(), valid * sizeof(char32_t));
+        out += valid;
+        if (valid >= src.size()) { break; }
+        *out++ = REPLACEMENT_CHARACTER;
+        src.remove_prefix(valid + 1);
+    }
+    return out;
+}
+
+
+} // namespace utfcpp::detail
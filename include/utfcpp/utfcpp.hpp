@@ -20,5 +20,14 @@
 #include "utfcpp/concepts.hpp"
 #include "utfcpp/exception.hpp"
 #include "utfcpp/iterator.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/transcode.hpp"
 #include "utfcpp/views.hpp"
 #include "utfcpp/utility.hpp"
+#include "utfcpp/stream.hpp"
+#include "utfcpp/parallel.hpp"
+#include "utfcpp/index.hpp"
+#include "utfcpp/file.hpp"
+#include "utfcpp/latin1.hpp"
+#include "utfcpp/endian.hpp"
+#include "utfcpp/detect.hpp"
@@ -16,7 +16,12 @@
 
 
 #include <algorithm>
+#include <array>
+#include <concepts>
 #include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -24,8 +29,11 @@
 
 #include "utfcpp/concepts.hpp"
 #include "utfcpp/core.hpp"
+#include "utfcpp/exception.hpp"
 //#include "utfcpp/decode_encode.hpp"
 #include "utfcpp/iterator.hpp"
+#include "utfcpp/simd.hpp"
+#include "utfcpp/transcode.hpp"
 #include "utfcpp/views.hpp"
 
 
@@ -34,6 +42,21 @@ namespace utfcpp {
 
 template <IsUTF_c T, template<typename> typename Iter_t=UTFInputIterator>
 constexpr size_t FindInvalid(std::basic_string_view<T> src) {
+    if constexpr (std::is_same_v<T, char8_t> && std::is_same_v<Iter_t<T>, UTFInputIterator<T>>) {
+        // The vector validator clears whole blocks; the scalar loop below pinpoints the error, if any,
+        // skipping ASCII runs in blocks and decoding only what lies between them.
+        size_t pos = detail::ValidUTF8Prefix(src);
+        while (pos < src.size()) {
+            pos += AsciiPrefixLength(src.substr(pos));
+            if (pos >= src.size()) { break; }
+            DecodeData data = DecodeUTF8(src.substr(pos));
+            if (data.error_code != UTF_ERROR::OK) { return pos; }
+            pos += data.consumed;
+        }
+        return src.size();
+    } else if constexpr (std::is_same_v<T, char32_t> && std::is_same_v<Iter_t<T>, UTFInputIterator<T>>) {
+        if !consteval { return detail::ValidUTF32PrefixLength(src); }
+    }
     UTFView<T, Iter_t> view{src};
     auto src_iter = view.begin();
     for (; src_iter != view.end(); ++src_iter) {
@@ -53,13 +76,333 @@ constexpr bool IsValid(std::basic_string_view<T> src) noexcept {
 }
 
 
+namespace detail {
+
+
+// Length of valid utf-8 once encoded as Dst_t; counts lead bytes (and 4 byte leads for surrogate pairs).
+template <IsUTF_c Dst_t>
+constexpr size_t EncodedLengthValidUTF8(std::u8string_view utf8str) noexcept {
+    if constexpr (std::is_same_v<Dst_t, char8_t>) {
+        return utf8str.size();
+    } else if constexpr (std::is_same_v<Dst_t, char16_t>) {
+        return CountLeadBytesUTF8(utf8str) + CountFourByteLeadsUTF8(utf8str);
+    } else {
+        return CountLeadBytesUTF8(utf8str);
+    }
+}
+
+
+// Offset of the code point n code points into valid utf-8, or its size if it holds no more than n;
+// n is reduced by the number of code points skipped.
+constexpr size_t SkipValidUTF8(std::u8string_view utf8str, size_t& n) noexcept {
+    size_t pos = 0;
+    for (; pos + ASCII_BLOCK_SIZE <= utf8str.size(); pos += ASCII_BLOCK_SIZE) {
+        const size_t count = CountLeadBytesUTF8(utf8str.substr(pos, ASCII_BLOCK_SIZE));
+        if (count > n) { break; }
+        n -= count;
+    }
+    for (; pos < utf8str.size(); ++pos) {
+        if (IsTrailUTF8(utf8str[pos])) { continue; }
+        if (n == 0) { return pos; }
+        --n;
+    }
+    return utf8str.size();
+}
+
+
+template <IsUTF_c Dst_t>
+constexpr Dst_t* WriteCodePoint(char32_t code_point, Dst_t* out) noexcept {
+    if constexpr (std::is_same_v<Dst_t, char8_t>)       { return out + EncodeUTF8(code_point, out); }
+    else if constexpr (std::is_same_v<Dst_t, char16_t>) { return out + EncodeUTF16(code_point, out); }
+    else {
+        *out = is_code_point_valid(code_point) ? code_point : REPLACEMENT_CHARACTER;
+        return out + 1;
+    }
+}
+
+
+// Decodes the first code point of src; errors consume one code unit.
+template <IsUTF_c Src_t>
+constexpr DecodeData DecodeOne(std::basic_string_view<Src_t> src) noexcept {
+    if constexpr (std::is_same_v<Src_t, char8_t>)       { return DecodeUTF8(src); }
+    else if constexpr (std::is_same_v<Src_t, char16_t>) { return DecodeUTF16(src); }
+    else {
+        if (src.empty()) { return DecodeData{.error_code=UTF_ERROR::INCOMPLETE_SEQUENCE}; }
+        if (!is_code_point_valid(src[0])) { return DecodeData{.consumed=1, .error_code=UTF_ERROR::INVALID_CODE_POINT}; }
+        return DecodeData{.consumed=1, .code_point=src[0], .error_code=UTF_ERROR::OK};
+    }
+}
+
+
+template <IsUTF_c Dst_t>
+constexpr size_t EncodedLengthOne(char32_t code_point) noexcept {
+    if constexpr (std::is_same_v<Dst_t, char8_t>)       { return EncodedLengthUTF8(code_point); }
+    else if constexpr (std::is_same_v<Dst_t, char16_t>) { return EncodedLengthUTF16(code_point); }
+    else                                                { return 1; }
+}
+
+
+// Largest position not after pos at which src can be split without splitting a code point.
+template <IsUTF_c Src_t>
+constexpr size_t SafeSplit(std::basic_string_view<Src_t> src, size_t pos) noexcept {
+    if (pos == 0 || pos >= src.size()) { return pos; }
+    if constexpr (std::is_same_v<Src_t, char8_t>) {
+        return IsTrailUTF8(src[pos]) ? CodePointBoundaryUTF8(src.data(), pos) : pos;
+    } else if constexpr (std::is_same_v<Src_t, char16_t>) {
+        return IsLeadSurrogateUTF16(src[pos - 1]) ? pos - 1 : pos;
+    } else {
+        return pos;
+    }
+}
+
+
+// Converts all of src into [out, out_end), which must have room for at least EncodedLength code units.
+// Returns the end of the written output.
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+constexpr Dst_t* Transcode(std::basic_string_view<Src_t> src, Dst_t* out, [[maybe_unused]] Dst_t* out_end) noexcept {
+    if !consteval {
+        if constexpr (std::is_same_v<Src_t, char8_t> && !std::is_same_v<Dst_t, char8_t>) {
+            return TranscodeFromUTF8(src, out, out_end);
+        } else if constexpr (std::is_same_v<Src_t, char16_t> && std::is_same_v<Dst_t, char8_t>) {
+            return TranscodeUTF16ToUTF8(src, out, out_end);
+        } else if constexpr (std::is_same_v<Src_t, char16_t> && std::is_same_v<Dst_t, char32_t>) {
+            return TranscodeUTF16ToUTF32(src, out, out_end);
+        } else if constexpr (std::is_same_v<Src_t, char32_t> && !std::is_same_v<Dst_t, char32_t>) {
+            return TranscodeFromUTF32(src, out, out_end);
+        } else if constexpr (std::is_same_v<Src_t, char32_t>) {
+            return TranscodeUTF32ToUTF32(src, out);
+        }
+    }
+    if constexpr (std::is_same_v<Src_t, char8_t>) {
+        // ASCII runs map one-to-one onto the destination; only the code points between them are decoded.
+        size_t pos = 0;
+        while (pos < src.size()) {
+            const size_t run = AsciiPrefixLength(src.substr(pos));
+            out = std::ranges::copy(src.substr(pos, run), out).out;
+            pos += run;
+            if (pos >= src.size()) { break; }
+            DecodeData data = DecodeUTF8(src.substr(pos));
+            out = WriteCodePoint(data.code_point, out);
+            pos += data.consumed ? data.consumed : 1;
+        }
+    } else {
+        for (char32_t code_point : UTFView<Src_t>{src}) {
+            out = WriteCodePoint(code_point, out);
+        }
+    }
+    return out;
+}
+
+
+// The most destination code units a single source code unit can turn into
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+inline constexpr size_t MAX_EXPANSION = std::is_same_v<Dst_t, char8_t> ? (std::is_same_v<Src_t, char32_t> ? 4 : 3) :
+                                        (std::is_same_v<Dst_t, char16_t> && std::is_same_v<Src_t, char32_t>) ? 2 : 1;
+
+
+// Converts the longest prefix of src whose output fits into [out_first, out_end), replacing invalid code
+// units as Transcode does. Stops at a code point boundary with NOT_ENOUGH_ROOM unless all of src fits.
+// Prefixes whose output certainly fits go to the bulk kernels; once room runs low, code points are
+// written one at a time.
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+constexpr TranscodeResult TranscodeInto(std::basic_string_view<Src_t> src, Dst_t* const out_first, Dst_t* const out_end) noexcept {
+    Dst_t* out = out_first;
+    size_t pos = 0;
+    UTF_ERROR error_code = UTF_ERROR::OK;
+    while (pos < src.size()) {
+        const std::basic_string_view<Src_t> rest = src.substr(pos);
+        const size_t room = static_cast<size_t>(out_end - out);
+        const size_t bulk = SafeSplit(rest, std::min(rest.size(), room / MAX_EXPANSION<Src_t, Dst_t>));
+        if (bulk) {
+            out = Transcode<Src_t, Dst_t>(rest.substr(0, bulk), out, out_end);
+            pos += bulk;
+            continue;
+        }
+        const DecodeData data = DecodeOne(rest);
+        if (EncodedLengthOne<Dst_t>(data.code_point) > room) {
+            error_code = UTF_ERROR::NOT_ENOUGH_ROOM;
+            break;
+        }
+        out = WriteCodePoint(data.code_point, out);
+        pos += data.consumed;
+    }
+    return TranscodeResult{.consumed=pos, .produced=static_cast<size_t>(out - out_first), .error_code=error_code};
+}
+
+
+} // namespace detail
+
+
+// Exact number of Dst_t code units UTFConvertTo produces for src, REPLACEMENT_CHARACTERs included.
+template <IsUTF_c Dst_t, IsUTF_c Src_t>
+constexpr size_t EncodedLength(std::basic_string_view<Src_t> src) noexcept {
+    if constexpr (std::is_same_v<Src_t, char8_t>) {
+        // Valid stretches are counted per byte; every invalid byte becomes one REPLACEMENT_CHARACTER.
+        size_t length = 0;
+        while (!src.empty()) {
+            const size_t valid = FindInvalid<char8_t>(src);
+            length += detail::EncodedLengthValidUTF8<Dst_t>(src.substr(0, valid));
+            if (valid >= src.size()) { break; }
+            length += std::is_same_v<Dst_t, char8_t> ? EncodedLengthUTF8(REPLACEMENT_CHARACTER) : 1;
+            src.remove_prefix(valid + 1);
+        }
+        return length;
+    } else if constexpr (std::is_same_v<Src_t, char16_t>) {
+        // Unpaired surrogates become one REPLACEMENT_CHARACTER each, so utf-16 keeps its length.
+        if constexpr (std::is_same_v<Dst_t, char16_t>) { return src.size(); }
+        size_t length = 0;
+        for (size_t i = 0; i < src.size(); ++i) {
+            const char16_t unit = src[i];
+            const bool paired = (IsLeadSurrogateUTF16(unit) && i + 1 < src.size() && IsTrailSurrogateUTF16(src[i + 1])) ||
+                                (IsTrailSurrogateUTF16(unit) && i > 0 && IsLeadSurrogateUTF16(src[i - 1]));
+            if constexpr (std::is_same_v<Dst_t, char8_t>) {
+                length += IsSurrogateUTF16(unit) ? (paired ? 2 : 3) : EncodedLengthUTF8(unit);
+            } else {
+                length += !(paired && IsTrailSurrogateUTF16(unit));
+            }
+        }
+        return length;
+    } else {
+        if constexpr (std::is_same_v<Dst_t, char32_t>) { return src.size(); }
+        size_t length = 0;
+        for (char32_t code_point : src) {
+            if constexpr (std::is_same_v<Dst_t, char8_t>) { length += EncodedLengthUTF8(code_point); }
+            else                                         { length += EncodedLengthUTF16(code_point); }
+        }
+        return length;
+    }
+}
+
+
+// Number of code points UTFView yields for src, every invalid code unit counting as one.
+template <IsUTF_c T>
+constexpr size_t CountCodePoints(std::basic_string_view<T> src) noexcept {
+    if constexpr (std::is_same_v<T, char16_t>) {
+        // Only a trail surrogate directly after a lead surrogate does not start a code point of its own.
+        size_t pairs = 0;
+        for (size_t i = 1; i < src.size(); ++i) {
+            pairs += IsTrailSurrogateUTF16(src[i]) && IsLeadSurrogateUTF16(src[i - 1]);
+        }
+        return src.size() - pairs;
+    } else {
+        return EncodedLength<char32_t, T>(src);
+    }
+}
+
+
+template <IsUTF_c T, template<typename> typename Iter_t=UTFInputIterator>
+constexpr size_t CountCodePoints(UTFView<T, Iter_t> view) noexcept {
+    if constexpr (std::is_same_v<Iter_t<T>, UTFInputIterator<T>>) {
+        return CountCodePoints<T>(view.data());
+    } else {
+        return static_cast<size_t>(std::ranges::distance(view.begin(), view.end()));
+    }
+}
+
+
+// Offset in code units of the code point n code points into src, or src.size() if there are no more
+// than n. Code points are split as UTFView splits them.
+template <IsUTF_c T>
+constexpr size_t CodePointOffset(std::basic_string_view<T> src, size_t n) noexcept {
+    if constexpr (std::is_same_v<T, char8_t>) {
+        // Validated blocks are skipped by counting lead bytes; ASCII runs and errors in between are stepped over.
+        size_t pos = 0;
+        while (n && pos < src.size()) {
+            const std::u8string_view rest = src.substr(pos);
+            // n code points span at most 4n bytes; no point validating beyond them
+            const size_t valid = detail::ValidUTF8Prefix(rest.substr(0, std::min(n, ASCII_BLOCK_SIZE * 16) * 4));
+            if (valid) {
+                pos += detail::SkipValidUTF8(rest.substr(0, valid), n);
+                continue;
+            }
+            const size_t run = AsciiPrefixLength(rest.substr(0, n));
+            if (run) {
+                pos += run;
+                n -= run;
+                continue;
+            }
+            const DecodeData data = DecodeUTF8(rest);
+            pos += data.consumed ? data.consumed : 1;
+            --n;
+        }
+        return pos;
+    } else if constexpr (std::is_same_v<T, char16_t>) {
+        size_t pos = 0;
+        for (; n && pos < src.size(); --n) {
+            const bool paired = IsLeadSurrogateUTF16(src[pos]) && pos + 1 < src.size() && IsTrailSurrogateUTF16(src[pos + 1]);
+            pos += paired ? 2 : 1;
+        }
+        return pos;
+    } else {
+        return std::min(n, src.size());
+    }
+}
+
+
+// Decodes as many code points of src as fit into out, REPLACEMENT_CHARACTERs included, and reports the first
+// invalid sequence met. Call again with src.substr(consumed) for the next block. The block is filled by the
+// bulk kernels in a few rounds: every round converts a prefix of src with no more code units than the room left.
+template <IsUTF_c T>
+constexpr TranscodeResult DecodeBlock(std::basic_string_view<T> src, std::span<char32_t> out) noexcept {
+    TranscodeResult result{};
+    while (result.consumed < src.size() && result.produced < out.size()) {
+        const std::basic_string_view<T> rest = src.substr(result.consumed);
+        const size_t room = out.size() - result.produced;
+        std::basic_string_view<T> chunk = rest.substr(0, detail::SafeSplit(rest, std::min(room, rest.size())));
+        if (chunk.empty()) { chunk = rest.substr(0, detail::DecodeOne(rest).consumed); }
+        if (result.error_code == UTF_ERROR::OK) {
+            const size_t valid = FindInvalid<T>(chunk);
+            if (valid < chunk.size()) { result.error_code = detail::DecodeOne(rest.substr(valid)).error_code; }
+        }
+        char32_t* const first = out.data() + result.produced;
+        result.produced += static_cast<size_t>(detail::Transcode<T, char32_t>(chunk, first, out.data() + out.size()) - first);
+        result.consumed += chunk.size();
+    }
+    return result;
+}
+
+
+// The code points of view following its first n.
+template <IsUTF_c T, template<typename> typename Iter_t=UTFInputIterator>
+constexpr UTFView<T, Iter_t> Advance(UTFView<T, Iter_t> view, size_t n) noexcept {
+    if constexpr (std::is_same_v<Iter_t<T>, UTFInputIterator<T>>) {
+        return UTFView<T, Iter_t>{view.data().substr(CodePointOffset<T>(view.data(), n))};
+    } else {
+        auto iter = view.begin();
+        for (; n && iter != view.end(); --n) { ++iter; }
+        return UTFView<T, Iter_t>{iter.Data()};
+    }
+}
+
+
 // Assumes input is validated; will replace invalid code points with REPLACEMENT_CHARACTER.
-// User can consider using shrink_to_fit to reduce overall allocated size if concerned about footprint.
-template <typename Src_t, IsUTF_c Dst_t, template<typename> typename Iter_t=UTFInputIterator>
-constexpr std::basic_string<Dst_t> UTFConvertTo(std::basic_string_view<Src_t> src) {
-    std::basic_string<Dst_t> result{};
-    result.reserve(src.size()); // TODO: pre-allocate return string in a smarter way
-    std::ranges::transform(UTFView<Src_t, Iter_t>{src}, CodePointAppender(result), std::identity{});
+// The result is sized exactly by a counting pre-pass and written in place, in one allocation from alloc.
+template <typename Src_t, IsUTF_c Dst_t, template<typename> typename Iter_t=UTFInputIterator,
+          typename Alloc_t=std::allocator<Dst_t>>
+constexpr std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> UTFConvertTo(std::basic_string_view<Src_t> src,
+                                                                              const Alloc_t& alloc = Alloc_t{}) {
+    constexpr bool default_iterator = std::is_same_v<Iter_t<Src_t>, UTFInputIterator<Src_t>>;
+    std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> result(alloc);
+    size_t length = 0;
+    if constexpr (default_iterator) {
+        length = EncodedLength<Dst_t, Src_t>(src);
+    } else {
+        // Other iterators may decode differently; size the output from what they actually produce.
+        for (char32_t code_point : UTFView<Src_t, Iter_t>{src}) {
+            length += detail::EncodedLengthOne<Dst_t>(code_point);
+        }
+    }
+    result.resize_and_overwrite(length, [src, length](Dst_t* out, size_t) {
+        Dst_t* const first = out;
+        if constexpr (default_iterator) {
+            out = detail::Transcode<Src_t, Dst_t>(src, out, out + length);
+        } else {
+            for (char32_t code_point : UTFView<Src_t, Iter_t>{src}) {
+                out = detail::WriteCodePoint(code_point, out);
+            }
+        }
+        return static_cast<size_t>(out - first);
+    });
     return result;
 }
 
@@ -91,6 +434,288 @@ template <template<typename> typename Iter_t=UTFInputIterator>
 constexpr std::u32string utf32_to_32(std::u32string_view sv) { return UTFConvertTo<char32_t, char32_t, Iter_t>(sv); }
 
 
+// The utfX_to_Y helpers allocating from a memory resource, e.g. a per-request monotonic_buffer_resource.
+namespace pmr {
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u8string utf8_to_8(std::u8string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char8_t, char8_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char8_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u16string utf8_to_16(std::u8string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char8_t, char16_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char16_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u32string utf8_to_32(std::u8string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char8_t, char32_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char32_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u8string utf16_to_8(std::u16string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char16_t, char8_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char8_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u16string utf16_to_16(std::u16string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char16_t, char16_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char16_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u32string utf16_to_32(std::u16string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char16_t, char32_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char32_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u8string utf32_to_8(std::u32string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char32_t, char8_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char8_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u16string utf32_to_16(std::u32string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char32_t, char16_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char16_t>{resource});
+}
+
+template <template<typename> typename Iter_t=UTFInputIterator>
+std::pmr::u32string utf32_to_32(std::u32string_view sv, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+    return UTFConvertTo<char32_t, char32_t, Iter_t>(sv, std::pmr::polymorphic_allocator<char32_t>{resource});
+}
+
+} // namespace pmr
+
+
+/***
+ * Error policies for UTFConvert
+ *
+ * ReplaceInvalid: every invalid code unit becomes a REPLACEMENT_CHARACTER, as with UTFConvertTo
+ * SkipInvalid:    invalid code units are dropped
+ * StopOnInvalid:  conversion stops before the first invalid code unit, which is reported
+ * ThrowOnInvalid: the first invalid code unit throws DecodingError, before anything is converted
+ */
+struct ReplaceInvalid {};
+struct SkipInvalid {};
+struct StopOnInvalid {};
+struct ThrowOnInvalid {};
+
+template <typename T> concept IsErrorPolicy_c = std::same_as<T, ReplaceInvalid> ||
+                                                std::same_as<T, SkipInvalid>    ||
+                                                std::same_as<T, StopOnInvalid>  ||
+                                                std::same_as<T, ThrowOnInvalid>;
+
+
+template <IsUTF_c Dst_t, typename Alloc_t = std::allocator<Dst_t>>
+struct ConvertResult {
+    std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t> str{};
+    size_t consumed{0};                  // source code units converted, or skipped
+    UTF_ERROR error_code{UTF_ERROR::OK}; // why conversion stopped; OK unless StopOnInvalid stopped early
+};
+
+
+namespace detail {
+
+
+// EncodedLength for src known to be valid; utf-8 is counted without validating it again.
+template <IsUTF_c Dst_t, IsUTF_c Src_t>
+constexpr size_t EncodedLengthValid(std::basic_string_view<Src_t> src) noexcept {
+    if constexpr (std::is_same_v<Src_t, char8_t>) { return EncodedLengthValidUTF8<Dst_t>(src); }
+    else                                         { return EncodedLength<Dst_t, Src_t>(src); }
+}
+
+
+} // namespace detail
+
+
+// UTFConvertTo with the handling of invalid input chosen at compile time. Apart from ReplaceInvalid, only
+// valid stretches are transcoded. StopOnInvalid and ThrowOnInvalid validate the input once, in the pass that
+// sizes the output; SkipInvalid finds its errors again while writing, which costs little on valid runs.
+template <IsErrorPolicy_c Policy, IsUTF_c Src_t, IsUTF_c Dst_t, typename Alloc_t = std::allocator<Dst_t>>
+constexpr ConvertResult<Dst_t, Alloc_t> UTFConvert(std::basic_string_view<Src_t> src, const Alloc_t& alloc = Alloc_t{}) {
+    ConvertResult<Dst_t, Alloc_t> result{.str=std::basic_string<Dst_t, std::char_traits<Dst_t>, Alloc_t>(alloc)};
+    if constexpr (std::is_same_v<Policy, ReplaceInvalid>) {
+        result.str = UTFConvertTo<Src_t, Dst_t, UTFInputIterator, Alloc_t>(src, alloc);
+        result.consumed = src.size();
+    } else if constexpr (std::is_same_v<Policy, SkipInvalid>) {
+        size_t length = 0;
+        for (std::basic_string_view<Src_t> rest = src; !rest.empty();) {
+            const size_t valid = FindInvalid<Src_t>(rest);
+            length += detail::EncodedLengthValid<Dst_t, Src_t>(rest.substr(0, valid));
+            rest.remove_prefix(std::min(valid + 1, rest.size()));
+        }
+        // Scanned again rather than recording the error positions, which would allocate outside alloc
+        result.str.resize_and_overwrite(length, [src, length](Dst_t* out, size_t) {
+            Dst_t* const first = out;
+            for (std::basic_string_view<Src_t> rest = src; !rest.empty();) {
+                const size_t valid = FindInvalid<Src_t>(rest);
+                out = detail::Transcode<Src_t, Dst_t>(rest.substr(0, valid), out, first + length);
+                rest.remove_prefix(std::min(valid + 1, rest.size()));
+            }
+            return length;
+        });
+        result.consumed = src.size();
+    } else {
+        const size_t valid = FindInvalid<Src_t>(src);
+        if (valid < src.size()) {
+            result.error_code = detail::DecodeOne(src.substr(valid)).error_code;
+            if constexpr (std::is_same_v<Policy, ThrowOnInvalid>) { OnDecodeErrorThrow_f(result.error_code); }
+        }
+        const std::basic_string_view<Src_t> prefix = src.substr(0, valid);
+        const size_t length = detail::EncodedLengthValid<Dst_t, Src_t>(prefix);
+        result.str.resize_and_overwrite(length, [prefix, length](Dst_t* out, size_t) {
+            detail::Transcode<Src_t, Dst_t>(prefix, out, out + length);
+            return length;
+        });
+        result.consumed = valid;
+    }
+    return result;
+}
+
+
+// Converts src into the caller's buffer, with invalid input handled as in UTFConvert. Nothing is allocated.
+// When the next code point does not fit, conversion stops before it with NOT_ENOUGH_ROOM, so the caller
+// can continue from src.substr(consumed) with more room. Each round validates only as much of src as the
+// remaining room could take, so filling small buffers from a long src is not quadratic.
+template <IsErrorPolicy_c Policy, IsUTF_c Src_t, IsUTF_c Dst_t>
+constexpr TranscodeResult UTFConvertInto(std::basic_string_view<Src_t> src, std::span<Dst_t> dst) {
+    Dst_t* const out_end = dst.data() + dst.size();
+    if constexpr (std::is_same_v<Policy, ReplaceInvalid>) {
+        return detail::TranscodeInto<Src_t, Dst_t>(src, dst.data(), out_end);
+    } else {
+        // No code point takes more than 4 source code units for a single destination code unit
+        constexpr size_t MAX_CONTRACTION = 4;
+        TranscodeResult result{};
+        while (result.consumed < src.size()) {
+            const std::basic_string_view<Src_t> rest = src.substr(result.consumed);
+            const size_t room = dst.size() - result.produced;
+            const std::basic_string_view<Src_t> window =
+                rest.substr(0, detail::SafeSplit(rest, std::min(rest.size(), std::max(room, size_t{1}) * MAX_CONTRACTION)));
+            const size_t valid = FindInvalid<Src_t>(window);
+            const TranscodeResult part =
+                detail::TranscodeInto<Src_t, Dst_t>(window.substr(0, valid), dst.data() + result.produced, out_end);
+            result.consumed += part.consumed;
+            result.produced += part.produced;
+            if (part.error_code != UTF_ERROR::OK) {
+                result.error_code = part.error_code;
+                break;
+            }
+            if (valid == window.size()) { continue; }
+            if constexpr (std::is_same_v<Policy, SkipInvalid>) {
+                ++result.consumed;
+            } else {
+                result.error_code = detail::DecodeOne(rest.substr(valid)).error_code;
+                if constexpr (std::is_same_v<Policy, ThrowOnInvalid>) { OnDecodeErrorThrow_f(result.error_code); }
+                break;
+            }
+        }
+        return result;
+    }
+}
+
+
+template <IsUTF_c Src_t, IsUTF_c Dst_t>
+constexpr TranscodeResult UTFConvertInto(std::basic_string_view<Src_t> src, std::span<Dst_t> dst) noexcept {
+    return UTFConvertInto<ReplaceInvalid, Src_t, Dst_t>(src, dst);
+}
+
+
+/***
+ * Fixed-size sink over caller memory, such as a network send buffer
+ *
+ * A code point that does not fit is dropped and the sink marked as overflowed; so is everything appended
+ * after it, so the contents are always the encoding of a prefix of the input.
+ */
+template <IsUTF_c T>
+class SpanSink {
+public:
+    using value_type = T;
+
+    constexpr SpanSink() noexcept = default;
+    constexpr explicit SpanSink(std::span<T> buffer) noexcept : buffer{buffer} {}
+
+    constexpr void append(const T* data, size_t n) noexcept {
+        if (overflow || n > buffer.size() - used) {
+            overflow = true;
+            return;
+        }
+        std::ranges::copy(data, data + n, buffer.begin() + used);
+        used += n;
+    }
+
+    constexpr void push_back(T unit) noexcept { append(&unit, 1); }
+
+    // Code units written so far
+    constexpr std::span<T> View() const noexcept { return buffer.first(used); }
+
+    constexpr size_t Size() const noexcept { return used; }
+
+    constexpr bool Overflow() const noexcept { return overflow; }
+
+    // Unused part of the buffer, for writers that fill it directly and then Commit what they wrote
+    constexpr std::span<T> Free() const noexcept { return buffer.subspan(used); }
+
+    constexpr void Commit(size_t n, bool overflowed = false) noexcept {
+        used += n;
+        overflow = overflow || overflowed;
+    }
+
+    constexpr void Clear() noexcept {
+        used = 0;
+        overflow = false;
+    }
+
+private:
+    std::span<T> buffer{};
+    size_t used{0};
+    bool overflow{false};
+};
+
+
+// Appends src, converted as UTFConvertTo converts it, to any code unit sink, without an intermediate string.
+// Containers of Dst_t that can be resized are grown once and written in place; a
+// SpanSink is filled up to its end, stopping with NOT_ENOUGH_ROOM; any other sink gets the output in
+// chunks from a small buffer, one bulk append per chunk.
+template <IsUTF_c Src_t, IsUTF_c Dst_t, IsCodeUnitSink_c<Dst_t> Sink_t>
+constexpr TranscodeResult UTFConvertAppend(std::basic_string_view<Src_t> src, Sink_t& sink) {
+    if constexpr (std::is_same_v<Sink_t, SpanSink<Dst_t>>) {
+        if (sink.Overflow()) { return TranscodeResult{.error_code=UTF_ERROR::NOT_ENOUGH_ROOM}; }
+        const std::span<Dst_t> free = sink.Free();
+        const TranscodeResult result = detail::TranscodeInto<Src_t, Dst_t>(src, free.data(), free.data() + free.size());
+        sink.Commit(result.produced, result.error_code == UTF_ERROR::NOT_ENOUGH_ROOM);
+        return result;
+    } else if constexpr (requires(Sink_t& s, size_t n) {
+                             { s.data() } -> std::same_as<Dst_t*>;
+                             s.resize(n);
+                             s.size();
+                         }) {
+        // When no code unit expands, src.size() is room enough and the pre-pass that sizes exactly is skipped
+        const size_t old_size = sink.size();
+        const size_t room = detail::MAX_EXPANSION<Src_t, Dst_t> == 1 ? src.size() : EncodedLength<Dst_t, Src_t>(src);
+        auto write = [src, old_size, room](Dst_t* out, size_t) {
+            Dst_t* const first = out + old_size;
+            return old_size + static_cast<size_t>(detail::Transcode<Src_t, Dst_t>(src, first, first + room) - first);
+        };
+        if constexpr (requires { sink.resize_and_overwrite(old_size + room, write); }) {
+            sink.resize_and_overwrite(old_size + room, write);
+        } else {
+            sink.resize(old_size + room);
+            sink.resize(write(sink.data(), old_size + room));
+        }
+        return TranscodeResult{.consumed=src.size(), .produced=sink.size() - old_size};
+    } else {
+        std::array<Dst_t, 256> chunk{};
+        TranscodeResult result{};
+        while (result.consumed < src.size()) {
+            const TranscodeResult part = detail::TranscodeInto<Src_t, Dst_t>(src.substr(result.consumed), chunk.data(),
+                                                                             chunk.data() + chunk.size());
+            detail::AppendCodeUnits(sink, chunk.data(), part.produced);
+            result.consumed += part.consumed;
+            result.produced += part.produced;
+        }
+        return result;
+    }
+}
+
+
 #if 0
 template <IsUTF_c Src_t, IsUTF_c Dst_t, template<typename> typename Iter_t=UTFInputIterator>
 constexpr std::tuple<size_t, UTF_ERROR> UTFAttemptConvertTo(std::basic_string_view<Src_t>& src,
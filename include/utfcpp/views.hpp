@@ -38,7 +38,11 @@ public:
     constexpr UTFView(string_view_type str_view) noexcept : str_view{str_view} {}
 
     constexpr auto begin() const noexcept { return utf_interator_type{str_view}; }
-    constexpr auto end() const noexcept { return typename utf_interator_type::sentinel{}; }
+    constexpr auto end() const noexcept {
+        // Iterators that can go backwards provide a real end iterator, making the view a common range
+        if constexpr (requires { utf_interator_type::End(str_view); }) { return utf_interator_type::End(str_view); }
+        else { return typename utf_interator_type::sentinel{}; }
+    }
 
     constexpr bool empty() const noexcept { return str_view.empty(); }
     constexpr      operator bool() const noexcept { return !str_view.empty(); }
@@ -23,6 +23,10 @@ TEST(CoreTests, test_IsTrailUTF8)
 
     EXPECT_TRUE(IsTrailUTF8(static_cast<char8_t>('\x80')));
     EXPECT_TRUE(IsTrailUTF8(static_cast<char8_t>('\x99')));
+    EXPECT_TRUE(IsTrailUTF8(static_cast<char8_t>('\xbf')));
+
+    EXPECT_FALSE(IsTrailUTF8(static_cast<char8_t>('\xc3')));
+    EXPECT_FALSE(IsTrailUTF8(static_cast<char8_t>('\xf0')));
 }
 
 TEST(CoreTests, test_IsLeadSurrogateUTF16)
@@ -126,6 +130,61 @@ TEST(CoreTests, test_DecodeUTF8)
     EXPECT_EQ(data.error_code, UTF_ERROR::OK);
     EXPECT_EQ(data.code_point, U'𐌀');
     EXPECT_EQ(data.consumed, 4);
+
+    // A lead byte cannot stand in for a trail byte
+    std::u8string two_leads{{0xc3, 0xc3}};
+    data = DecodeUTF8(two_leads);
+    EXPECT_EQ(data.error_code, UTF_ERROR::INCOMPLETE_SEQUENCE);
+    EXPECT_EQ(data.consumed, 1);
+}
+
+TEST(CoreTests, test_DecodeUTF8DFA)
+{
+    using namespace utfcpp;
+    // Every sequence of up to three bytes, and four byte ones whose trail bytes vary over the boundary values
+    auto expect_same = [](std::u8string_view str) {
+        const DecodeData expected = DecodeUTF8(str);
+        const DecodeData actual = DecodeUTF8DFA(str);
+        EXPECT_EQ(actual.consumed, expected.consumed);
+        EXPECT_EQ(actual.code_point, expected.code_point);
+        EXPECT_EQ(actual.error_code, expected.error_code);
+    };
+    expect_same(std::u8string_view{});
+    const char8_t edges[] = {0x00, 0x7f, 0x80, 0x8f, 0x90, 0x9f, 0xa0, 0xbf, 0xc0, 0xf4, 0xff};
+    for (unsigned a = 0; a < 0x100; ++a) {
+        for (unsigned b = 0; b < 0x100; ++b) {
+            const char8_t two[] = {static_cast<char8_t>(a), static_cast<char8_t>(b)};
+            expect_same(std::u8string_view{two, 1});
+            expect_same(std::u8string_view{two, 2});
+            if (a < 0xe0) { continue; }
+            for (unsigned c = 0; c < 0x100; ++c) {
+                const char8_t three[] = {static_cast<char8_t>(a), static_cast<char8_t>(b), static_cast<char8_t>(c)};
+                expect_same(std::u8string_view{three, 3});
+                if (a < 0xf0 || (c != 0x80 && c != 0xbf && c != 0x41)) { continue; }
+                for (char8_t d : edges) {
+                    const char8_t four[] = {static_cast<char8_t>(a), static_cast<char8_t>(b), static_cast<char8_t>(c), d};
+                    expect_same(std::u8string_view{four, 4});
+                }
+            }
+        }
+    }
+    static_assert(DecodeUTF8DFA(u8"水").code_point == U'水');
+}
+
+TEST(CoreTests, test_EncodedLength)
+{
+    using namespace utfcpp;
+    EXPECT_EQ(EncodedLengthUTF8(U'a'), 1);
+    EXPECT_EQ(EncodedLengthUTF8(U'ш'), 2);
+    EXPECT_EQ(EncodedLengthUTF8(U'水'), 3);
+    EXPECT_EQ(EncodedLengthUTF8(U'𐌀'), 4);
+    EXPECT_EQ(EncodedLengthUTF8(U'\xdc07'), EncodeUTF8(U'\xdc07').size());
+    EXPECT_EQ(EncodedLengthUTF8(U'\x11ffff'), EncodeUTF8(U'\x11ffff').size());
+
+    EXPECT_EQ(EncodedLengthUTF16(U'a'), 1);
+    EXPECT_EQ(EncodedLengthUTF16(U'水'), 1);
+    EXPECT_EQ(EncodedLengthUTF16(U'𐌀'), 2);
+    EXPECT_EQ(EncodedLengthUTF16(U'\x11ffff'), EncodeUTF16(U'\x11ffff').size());
 }
 
 TEST(CoreTests, test_EncodeUTF8)
@@ -146,6 +205,42 @@ TEST(CoreTests, test_EncodeUTF8)
     EXPECT_EQ(utf8str, u8"𐌀");
 }
 
+TEST(CoreTests, test_EncodeUTF8_buffer)
+{
+    using namespace utfcpp;
+    char8_t buffer[4]{};
+
+    EXPECT_EQ(EncodeUTF8(U'a', buffer), 1);
+    EXPECT_EQ(std::u8string_view(buffer, 1), u8"a");
+
+    EXPECT_EQ(EncodeUTF8(U'ц', buffer), 2);
+    EXPECT_EQ(std::u8string_view(buffer, 2), u8"ц");
+
+    EXPECT_EQ(EncodeUTF8(U'水', std::span<char8_t, 4>{buffer}), 3);
+    EXPECT_EQ(std::u8string_view(buffer, 3), u8"水");
+
+    EXPECT_EQ(EncodeUTF8(U'𐌀', buffer), 4);
+    EXPECT_EQ(std::u8string_view(buffer, 4), u8"𐌀");
+
+    EXPECT_EQ(EncodeUTF8(U'\x11ffff', buffer), 3);
+    EXPECT_EQ(std::u8string_view(buffer, 3), u8"\ufffd");
+}
+
+TEST(CoreTests, test_EncodeUTF16)
+{
+    using namespace utfcpp;
+    EXPECT_EQ(EncodeUTF16(U'a'), u"a");
+    EXPECT_EQ(EncodeUTF16(U'水'), u"水");
+    EXPECT_EQ(EncodeUTF16(U'𐌀'), u"𐌀");
+    EXPECT_EQ(EncodeUTF16(U'\xdc07'), u"\ufffd");
+
+    char16_t buffer[2]{};
+    EXPECT_EQ(EncodeUTF16(U'ш', buffer), 1);
+    EXPECT_EQ(std::u16string_view(buffer, 1), u"ш");
+    EXPECT_EQ(EncodeUTF16(U'𐌀', std::span<char16_t, 2>{buffer}), 2);
+    EXPECT_EQ(std::u16string_view(buffer, 2), u"𐌀");
+}
+
 TEST(CoreTests, test_DecodeUTF16)
 {
     using namespace utfcpp;
@@ -169,3 +264,21 @@ TEST(CoreTests, test_DecodeUTF16)
     EXPECT_EQ(data.code_point, U'𐌀');
     EXPECT_EQ(data.consumed, 2);
 }
+
+TEST(CoreTests, test_AsciiPrefixLength)
+{
+    using namespace utfcpp;
+    EXPECT_EQ(AsciiPrefixLength(std::u8string_view{}), 0);
+    EXPECT_EQ(AsciiPrefixLength(u8"abcdxyz"), 7);
+    EXPECT_EQ(AsciiPrefixLength(u8"шницла"), 0);
+    EXPECT_EQ(AsciiPrefixLength(u8"abcdxyzшницла"), 7);
+    static_assert(AsciiPrefixLength(u8"ab水") == 2);
+
+    // Non-ASCII byte at every offset across the vector block boundaries
+    for (size_t len = 0; len < 3 * ASCII_BLOCK_SIZE; ++len) {
+        std::u8string str(len, u8'a');
+        EXPECT_EQ(AsciiPrefixLength(str), len);
+        str.append(u8"水abc");
+        EXPECT_EQ(AsciiPrefixLength(str), len);
+    }
+}
@@ -0,0 +1,120 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <bit>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+#include "test_helpers.hpp"
+
+template <typename T>
+static std::vector<std::byte> Bytes(std::basic_string_view<T> str)
+{
+    const auto bytes = std::as_bytes(std::span{str});
+    return {bytes.begin(), bytes.end()};
+}
+
+static bool Detects(const std::vector<std::byte>& bytes, utfcpp::ENCODING encoding, size_t bom_size = 0,
+                    size_t sample_size = utfcpp::DETECT_SAMPLE_SIZE)
+{
+    const utfcpp::DetectedEncoding detected = utfcpp::DetectEncoding(bytes, sample_size);
+    return detected.encoding == encoding && detected.bom_size == bom_size;
+}
+
+static const std::u32string english = U"The quick brown fox jumps over the lazy dog, again and again.";
+static const std::u32string russian = U"Съешь же ещё этих мягких французских булок, да выпей чаю.";
+
+TEST(DetectTests, test_bom)
+{
+    using namespace utfcpp;
+    const std::u16string text16 = utf32_to_16(russian);
+    std::u16string bom16 = u"\xfeff" + text16;
+    std::u32string bom32 = U"\xfeff" + russian;
+    EXPECT_TRUE(Detects(Bytes<char8_t>(u8"﻿abc"), ENCODING::UTF8, 3));
+    EXPECT_TRUE(Detects(Serialize<char16_t>(bom16, std::endian::little), ENCODING::UTF16LE, 2));
+    EXPECT_TRUE(Detects(Serialize<char16_t>(bom16, std::endian::big), ENCODING::UTF16BE, 2));
+    EXPECT_TRUE(Detects(Serialize<char32_t>(bom32, std::endian::little), ENCODING::UTF32LE, 4));
+    EXPECT_TRUE(Detects(Serialize<char32_t>(bom32, std::endian::big), ENCODING::UTF32BE, 4));
+
+    // The BOM alone decides, whatever follows it
+    EXPECT_TRUE(Detects(Serialize<char16_t>(u"\xfeff", std::endian::big), ENCODING::UTF16BE, 2));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(u8"﻿"), ENCODING::UTF8, 3));
+}
+
+TEST(DetectTests, test_heuristic)
+{
+    using namespace utfcpp;
+    EXPECT_TRUE(Detects({}, ENCODING::UTF8));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf32_to_8(english)), ENCODING::UTF8));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf32_to_8(russian)), ENCODING::UTF8));
+    EXPECT_TRUE(Detects(Bytes<char>("na\xefve caf\xe9"), ENCODING::LATIN1));
+    for (const std::u32string& text : {english, russian, std::u32string{U"emoji 😀 and 𐌀 too"}}) {
+        const std::u16string text16 = utf32_to_16(text);
+        EXPECT_TRUE(Detects(Serialize<char16_t>(text16, std::endian::little), ENCODING::UTF16LE));
+        EXPECT_TRUE(Detects(Serialize<char16_t>(text16, std::endian::big), ENCODING::UTF16BE));
+        EXPECT_TRUE(Detects(Serialize<char32_t>(text, std::endian::little), ENCODING::UTF32LE));
+        EXPECT_TRUE(Detects(Serialize<char32_t>(text, std::endian::big), ENCODING::UTF32BE));
+    }
+
+    // NULs in no pattern and invalid utf-8: binary. NULs in valid utf-8 are still utf-8.
+    EXPECT_TRUE(Detects(Bytes<char>(std::string_view{"\xff\x00\xff\xff\x00\xff", 6}), ENCODING::UNKNOWN));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(std::u8string_view{u8"a\0b\0\0c", 6}), ENCODING::UTF8));
+    // Invalid utf-16 is not taken for utf-16
+    EXPECT_TRUE(Detects(Serialize<char16_t>(std::u16string{u'a', u'b', char16_t{0xdc00}, u'c'}, std::endian::little),
+                        ENCODING::UNKNOWN));
+}
+
+TEST(DetectTests, test_sample)
+{
+    using namespace utfcpp;
+    // Only the sample is inspected; code points it cuts off are not errors.
+    std::u8string utf8 = u8"abcd€";
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf8), ENCODING::UTF8, 0, 5));
+    utf8.push_back(0xff);
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf8), ENCODING::UTF8, 0, 7));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf8), ENCODING::LATIN1, 0, 8));
+    EXPECT_TRUE(Detects(Serialize<char16_t>(u"a😀b", std::endian::little), ENCODING::UTF16LE, 0, 4));
+
+    std::u32string long_text{};
+    for (int i = 0; i < 200; ++i) { long_text += russian; }
+    EXPECT_TRUE(Detects(Serialize<char16_t>(utf32_to_16(long_text), std::endian::big), ENCODING::UTF16BE));
+    EXPECT_TRUE(Detects(Bytes<char8_t>(utf32_to_8(long_text) + u8"\xff"), ENCODING::UTF8));
+    EXPECT_TRUE(ToString(ENCODING::UTF16BE) == "UTF-16BE");
+}
+
+TEST(DetectTests, test_convert_detected)
+{
+    using namespace utfcpp;
+    const std::u16string text16 = utf32_to_16(russian);
+    std::u16string bom16 = u"\xfeff" + text16;
+    EXPECT_TRUE(UTFConvertDetectedTo<char16_t>(Serialize<char16_t>(bom16, std::endian::big)) == text16);
+    EXPECT_TRUE(UTFConvertDetectedTo<char16_t>(Serialize<char16_t>(text16, std::endian::little)) == text16);
+    EXPECT_TRUE(UTFConvertDetectedTo<char32_t>(Serialize<char32_t>(russian, std::endian::big)) == russian);
+    EXPECT_TRUE(UTFConvertDetectedTo<char8_t>(Bytes<char8_t>(u8"﻿abc")) == u8"abc");
+    EXPECT_TRUE(UTFConvertDetectedTo<char8_t>(Bytes<char>("caf\xe9")) == u8"café");
+
+    // The arena cannot grow, so the result must come from buffer
+    std::byte buffer[1024];
+    std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+    std::pmr::u16string pmr16 = UTFConvertDetectedTo<char16_t>(Serialize<char16_t>(bom16, std::endian::big),
+                                                              std::pmr::polymorphic_allocator<char16_t>{&arena});
+    EXPECT_TRUE(std::u16string_view{pmr16} == text16);
+    const auto* data = reinterpret_cast<const std::byte*>(pmr16.data());
+    EXPECT_TRUE(data >= buffer && data < buffer + sizeof(buffer));
+}
@@ -0,0 +1,129 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+#include "test_helpers.hpp"
+
+// Text long enough for several chunks, with a surrogate pair across every chunk boundary.
+static std::u32string LongText()
+{
+    std::u32string text{};
+    const char32_t pieces[] = {U'a', U'é', U'水', U'𐌀', U' ', U'ш', U'😀'};
+    for (size_t i = 0; i < 5000; ++i) { text.push_back(pieces[(i * 7 + i / 13) % std::size(pieces)]); }
+    for (size_t pos = 1023; pos < 3000; pos += 1024) { text[pos] = U'𝄞'; }
+    return text;
+}
+
+TEST(EndianTests, test_convert)
+{
+    using namespace utfcpp;
+    const std::u16string text16 = utf32_to_16(LongText());
+    const std::u32string text32 = LongText();
+    for (std::endian order : {std::endian::little, std::endian::big}) {
+        const bool big = order == std::endian::big;
+        for (size_t skip : {0, 1}) {
+            const std::vector<std::byte> buffer16 = Serialize<char16_t>(text16, order, skip);
+            const std::span<const std::byte> bytes16 = std::span{buffer16}.subspan(skip);
+            EXPECT_TRUE((big ? utf16be_to_8(bytes16) : utf16le_to_8(bytes16)) == utf16_to_8(text16));
+            EXPECT_TRUE((big ? utf16be_to_16(bytes16) : utf16le_to_16(bytes16)) == text16);
+            EXPECT_TRUE((big ? utf16be_to_32(bytes16) : utf16le_to_32(bytes16)) == text32);
+
+            const std::vector<std::byte> buffer32 = Serialize<char32_t>(text32, order, skip);
+            const std::span<const std::byte> bytes32 = std::span{buffer32}.subspan(skip);
+            EXPECT_TRUE((big ? utf32be_to_8(bytes32) : utf32le_to_8(bytes32)) == utf32_to_8(text32));
+            EXPECT_TRUE((big ? utf32be_to_16(bytes32) : utf32le_to_16(bytes32)) == text16);
+            EXPECT_TRUE((big ? utf32be_to_32(bytes32) : utf32le_to_32(bytes32)) == text32);
+        }
+    }
+    EXPECT_TRUE(utf16be_to_8(std::span<const std::byte>{}).empty());
+
+    const std::byte hello_be[] = {std::byte{0}, std::byte{'h'}, std::byte{0}, std::byte{'i'}};
+    EXPECT_TRUE(utf16be_to_8(hello_be) == u8"hi");
+    EXPECT_TRUE(utf16le_to_8(hello_be) == u8"栀椀");
+}
+
+TEST(EndianTests, test_invalid)
+{
+    using namespace utfcpp;
+    std::u16string text16 = utf32_to_16(LongText());
+    text16[2000] = 0xdc00;
+    text16[4000] = 0xd800;
+    std::u32string text32 = LongText();
+    text32[3000] = 0x110000;
+    for (std::endian order : {std::endian::little, std::endian::big}) {
+        const std::vector<std::byte> bytes16 = Serialize<char16_t>(text16, order);
+        const std::vector<std::byte> bytes32 = Serialize<char32_t>(text32, order);
+        if (order == std::endian::big) {
+            EXPECT_EQ((FindInvalidEndian<char16_t, std::endian::big>(bytes16)), FindInvalid<char16_t>(text16) * 2);
+            EXPECT_EQ((FindInvalidEndian<char32_t, std::endian::big>(bytes32)), FindInvalid<char32_t>(text32) * 4);
+            EXPECT_TRUE((UTFConvertEndianTo<char16_t, std::endian::big, char8_t>(bytes16)) == utf16_to_8(text16));
+            EXPECT_TRUE((UTFConvertEndianTo<char32_t, std::endian::big, char8_t>(bytes32)) == utf32_to_8(text32));
+        } else {
+            EXPECT_EQ((FindInvalidEndian<char16_t, std::endian::little>(bytes16)), FindInvalid<char16_t>(text16) * 2);
+            EXPECT_EQ((FindInvalidEndian<char32_t, std::endian::little>(bytes32)), FindInvalid<char32_t>(text32) * 4);
+            EXPECT_TRUE((UTFConvertEndianTo<char16_t, std::endian::little, char8_t>(bytes16)) == utf16_to_8(text16));
+            EXPECT_TRUE((UTFConvertEndianTo<char32_t, std::endian::little, char8_t>(bytes32)) == utf32_to_8(text32));
+        }
+    }
+
+    // A lone lead surrogate at the very end, and a trailing partial code unit
+    const std::vector<std::byte> lead_at_end = Serialize<char16_t>(std::u16string{u'a', char16_t{0xd801}}, std::endian::big);
+    EXPECT_EQ((FindInvalidEndian<char16_t, std::endian::big>(lead_at_end)), 2u);
+    EXPECT_TRUE(utf16be_to_32(lead_at_end) == U"a\xfffd");
+    std::vector<std::byte> partial = Serialize<char16_t>(std::u16string{u"ab"}, std::endian::big);
+    partial.push_back(std::byte{0});
+    EXPECT_EQ((FindInvalidEndian<char16_t, std::endian::big>(partial)), 4u);
+    EXPECT_FALSE((IsValidEndian<char16_t, std::endian::big>(partial)));
+    EXPECT_TRUE((IsValidEndian<char16_t, std::endian::big>(std::span{partial}.first(4))));
+    EXPECT_TRUE(utf16be_to_8(partial) == u8"ab�");
+    partial.pop_back();
+    partial.pop_back();
+    EXPECT_TRUE(utf32be_to_8(partial) == u8"�");
+}
+
+TEST(EndianTests, test_view)
+{
+    using namespace utfcpp;
+    std::u16string text16 = u"a\xd800" u"b𐌀c";
+    text16.push_back(0xdbff);
+    const std::vector<std::byte> bytes = Serialize<char16_t>(text16, std::endian::big);
+
+    std::vector<std::tuple<char32_t, UTF_ERROR>> expected{};
+    const UTFView native{std::u16string_view{text16}};
+    for (auto it = native.begin(); it != native.end(); ++it) { expected.push_back(it.Decode()); }
+    std::vector<std::tuple<char32_t, UTF_ERROR>> decoded{};
+    const utf16be_view view{bytes};
+    for (auto it = view.begin(); it != view.end(); ++it) { decoded.push_back(it.Decode()); }
+    EXPECT_TRUE(decoded == expected);
+
+    std::u8string appended{};
+    std::ranges::copy(utf32le_view{Serialize<char32_t>(std::u32string{U"x😀"}, std::endian::little)}, CodePointAppender(appended));
+    EXPECT_TRUE(appended == u8"x😀");
+
+    const std::byte odd[] = {std::byte{0}, std::byte{'z'}, std::byte{0}};
+    std::u32string odd_decoded{};
+    std::ranges::copy(utf16be_view{odd}, CodePointAppender(odd_decoded));
+    EXPECT_TRUE(odd_decoded == U"z\xfffd");
+
+    constexpr std::byte be[] = {std::byte{0xd8}, std::byte{0x00}};
+    static_assert(detail::LoadCodeUnit<char16_t, std::endian::big>(be) == 0xd800);
+    static_assert(detail::LoadCodeUnit<char16_t, std::endian::little>(be) == 0x00d8);
+}
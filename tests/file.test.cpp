@@ -0,0 +1,96 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+
+// Temporary file holding the code units of str, removed on destruction.
+class TempFile {
+public:
+    template <typename T>
+    TempFile(const char* name, std::basic_string_view<T> str)
+        : path{std::filesystem::temp_directory_path() / name} {
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(str.data()), static_cast<std::streamsize>(str.size() * sizeof(T)));
+    }
+    ~TempFile() { std::filesystem::remove(path); }
+
+    std::filesystem::path path;
+};
+
+template <typename T>
+static std::basic_string<T> ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream in{path, std::ios::binary};
+    std::string bytes{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    return std::basic_string<T>(reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T));
+}
+
+TEST(FileTests, test_validate)
+{
+    using namespace utfcpp;
+    TempFile valid{"utfcpp_valid.txt", std::u8string_view{u8"abcdxyzшницла水手𐌀"}};
+    EXPECT_TRUE(IsValidFile<char8_t>(valid.path));
+    EXPECT_EQ(FindInvalidInFile<char8_t>(valid.path), std::u8string_view{u8"abcdxyzшницла水手𐌀"}.size());
+
+    std::u8string invalid{{0xe6, 0x97, 0xa5, 0xd1, 0x88, 0xfa, 0xe6, 0x97, 0xa5}};
+    TempFile invalid_file{"utfcpp_invalid.txt", std::u8string_view{invalid}};
+    EXPECT_FALSE(IsValidFile<char8_t>(invalid_file.path));
+    EXPECT_EQ(FindInvalidInFile<char8_t>(invalid_file.path), 5);
+
+    TempFile empty{"utfcpp_empty.txt", std::u8string_view{}};
+    EXPECT_TRUE(IsValidFile<char8_t>(empty.path));
+    EXPECT_TRUE(IsValidFile<char16_t>(empty.path));
+
+    // Three bytes are not a whole number of utf-16 code units
+    TempFile odd{"utfcpp_odd.txt", std::u8string_view{u8"abc"}};
+    bool thrown = false;
+    try { IsValidFile<char16_t>(odd.path); } catch (const DecodingError&) { thrown = true; }
+    EXPECT_TRUE(thrown);
+
+    thrown = false;
+    try { IsValidFile<char8_t>(std::filesystem::temp_directory_path() / "utfcpp_missing.txt"); }
+    catch (const std::system_error&) { thrown = true; }
+    EXPECT_TRUE(thrown);
+}
+
+TEST(FileTests, test_convert)
+{
+    using namespace utfcpp;
+    std::u8string utf8{u8"abcdxyzшницла水手𐌀"};
+    utf8.push_back(0xfa);
+    utf8.append(u8"😀");
+    TempFile src{"utfcpp_src.txt", std::u8string_view{utf8}};
+    TempFile dst{"utfcpp_dst.txt", std::u8string_view{u8"previous contents, longer than the output will be"}};
+
+    EXPECT_EQ((UTFConvertFileTo<char8_t, char16_t>(src.path)), utf8_to_16(utf8));
+    EXPECT_EQ((UTFConvertFile<char8_t, char16_t>(src.path, dst.path)), utf8_to_16(utf8).size());
+    EXPECT_EQ(ReadFile<char16_t>(dst.path), utf8_to_16(utf8));
+
+    EXPECT_EQ((UTFConvertFile<char16_t, char8_t>(dst.path, src.path)), utf16_to_8(utf8_to_16(utf8)).size());
+    EXPECT_EQ(ReadFile<char8_t>(src.path), utf16_to_8(utf8_to_16(utf8)));
+
+    bool thrown = false;
+    try { UTFConvertFile<char8_t, char16_t>(src.path, src.path); } catch (const std::invalid_argument&) { thrown = true; }
+    EXPECT_TRUE(thrown);
+
+    TempFile empty{"utfcpp_empty_src.txt", std::u8string_view{}};
+    EXPECT_EQ((UTFConvertFile<char8_t, char32_t>(empty.path, dst.path)), 0);
+    EXPECT_TRUE(std::filesystem::file_size(dst.path) == 0);
+}
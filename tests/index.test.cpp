@@ -0,0 +1,75 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <algorithm>
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+#include "test_helpers.hpp"
+
+TEST(IndexTests, test_empty)
+{
+    using namespace utfcpp;
+    CodePointIndex<char8_t> index{u8""};
+    EXPECT_EQ(index.Size(), 0);
+    EXPECT_EQ(index.Offset(0), 0);
+    EXPECT_EQ(index.Offset(5), 0);
+    EXPECT_TRUE(index.View(0).empty());
+}
+
+TEST(IndexTests, test_offsets)
+{
+    using namespace utfcpp;
+    std::u8string_view sv8{u8"aш水𐌀b"};
+    std::u16string_view sv16{u"aш水𐌀b"};
+    const size_t offsets8[] = {0, 1, 3, 6, 10, 11, 11};
+    const size_t offsets16[] = {0, 1, 2, 3, 5, 6, 6};
+    for (size_t stride : {1, 2, 3, 5, 6, 256}) {
+        CodePointIndex<char8_t> index8{sv8, stride};
+        CodePointIndex<char16_t> index16{sv16, stride};
+        EXPECT_EQ(index8.Size(), 5);
+        EXPECT_EQ(index16.Size(), 5);
+        for (size_t n = 0; n < std::size(offsets8); ++n) {
+            EXPECT_EQ(index8.Offset(n), offsets8[n]);
+            EXPECT_EQ(index16.Offset(n), offsets16[n]);
+        }
+    }
+    EXPECT_EQ(CodePointIndex<char8_t>(sv8, 0).Stride(), 1);
+}
+
+TEST(IndexTests, test_matches_view)
+{
+    using namespace utfcpp;
+    // Valid text with invalid sequences sprinkled in, long enough for many strides
+    const std::u8string pieces[] = {
+        u8"abc", u8"шницла", u8"水手", u8"𐌀", u8"😀", {0xfa}, {0xe6, 0x97}, {0xf0, 0x90, 0x8c}, {0xed, 0xa0, 0x80}
+    };
+    uint32_t seed = 31;
+    std::u8string str{};
+    while (str.size() < 20000) { str.append(RandomUTF(seed, 64, pieces, {.valid_count = 5, .invalid_odds = 16})); }
+
+    std::vector<size_t> expected{};
+    UTFView view{std::u8string_view{str}};
+    for (auto iter = view.begin(); iter != view.end(); ++iter) { expected.push_back(str.size() - iter.Data().size()); }
+
+    for (size_t stride : {7, 64, 1000}) {
+        CodePointIndex<char8_t> index{str, stride};
+        EXPECT_EQ(index.Size(), expected.size());
+        bool all_equal = true;
+        for (size_t n = 0; n < expected.size(); ++n) { all_equal = all_equal && index.Offset(n) == expected[n]; }
+        EXPECT_TRUE(all_equal);
+        EXPECT_EQ(index.Offset(expected.size()), str.size());
+        EXPECT_TRUE(std::ranges::equal(index.View(expected.size() / 2), UTFView{std::u8string_view{str}.substr(expected[expected.size() / 2])}));
+    }
+}
@@ -13,10 +13,14 @@
 //    limitations under the License.
 
 #include <algorithm>
+#include <memory_resource>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "utfcpp/utfcpp.hpp"
 #include "ftest.h"
+#include "test_helpers.hpp"
 
 TEST(IteratorTests, CodePointAppendIterator)
 {
@@ -67,6 +71,66 @@ TEST(IteratorTests, CodePointAppendIterator)
     EXPECT_EQ(out3, std::u32string{U"abcdxyzшницла水手𐌀abcdxyzшницла水手𐌀abcdxyzшницла水手𐌀"});
 }
 
+TEST(IteratorTests, CodePointAppendIterator_encode)
+{
+    using namespace utfcpp;
+    std::u32string_view sv32{U"abcdxyzшницла水手𐌀"};
+    std::u8string out8{};
+    std::ranges::copy(sv32, CodePointAppender(out8));
+    EXPECT_EQ(out8, std::u8string{u8"abcdxyzшницла水手𐌀"});
+
+    std::u16string out16{};
+    std::ranges::copy(sv32, CodePointAppender(out16));
+    EXPECT_EQ(out16, std::u16string{u"abcdxyzшницла水手𐌀"});
+}
+
+// A user-defined sink that only takes one code unit at a time
+struct ByteCounter {
+    using value_type = char8_t;
+    size_t count{0};
+    uint32_t sum{0};
+    void push_back(char8_t unit) { ++count; sum += unit; }
+};
+
+TEST(IteratorTests, CodePointAppendIterator_sinks)
+{
+    using namespace utfcpp;
+    std::u32string_view sv32{U"abcdxyzшницла水手𐌀"};
+    std::u8string_view sv8{u8"abcdxyzшницла水手𐌀"};
+
+    std::vector<char8_t> vec8{};
+    std::ranges::copy(sv32, CodePointAppender(vec8));
+    EXPECT_TRUE(std::u8string_view(vec8.data(), vec8.size()) == sv8);
+
+    std::vector<char> bytes{};
+    std::ranges::copy(sv32, CodePointAppender<char8_t>(bytes));
+    EXPECT_EQ(bytes.size(), sv8.size());
+    EXPECT_TRUE(std::ranges::equal(bytes, sv8, [](char a, char8_t b) { return static_cast<char8_t>(a) == b; }));
+
+    std::pmr::u16string pmr16{};
+    std::ranges::copy(sv32, CodePointAppendIterator(pmr16));
+    EXPECT_TRUE(std::u16string_view{pmr16} == u"abcdxyzшницла水手𐌀");
+
+    ByteCounter counter{};
+    std::ranges::copy(sv32, CodePointAppender(counter));
+    EXPECT_EQ(counter.count, sv8.size());
+    uint32_t sum = 0;
+    for (char8_t unit : sv8) { sum += unit; }
+    EXPECT_EQ(counter.sum, sum);
+
+    // Code points that do not fit are dropped whole, and so is everything after them
+    char8_t buffer[9]{};
+    SpanSink<char8_t> sink{std::span{buffer}};
+    std::ranges::copy(sv32, CodePointAppender(sink));
+    EXPECT_TRUE(sink.Overflow());
+    EXPECT_EQ(sink.Size(), 9);
+    EXPECT_TRUE(std::u8string_view(sink.View().data(), sink.Size()) == u8"abcdxyzш");
+    sink.Clear();
+    std::ranges::copy(std::u32string_view{U"шн"}, CodePointAppender(sink));
+    EXPECT_FALSE(sink.Overflow());
+    EXPECT_TRUE(std::u8string_view(sink.View().data(), sink.Size()) == u8"шн");
+}
+
 TEST(IteratorTests, UTFInputIterator_default_construct)
 {
     using namespace utfcpp;
@@ -250,15 +314,15 @@ TEST(IteratorTests, UTFInputIterator_dereference)
 
     // Invalid characters should return REPLACEMENT_CHARACTER
     char8_t cdata8[1] = {static_cast<char8_t>(0xf9)};
-    std::u8string str8{cdata8};
+    std::u8string str8{cdata8, 1};
     UTFInputIterator it83{std::u8string_view{str8}};
     EXPECT_EQ(*it83, REPLACEMENT_CHARACTER);
-    char16_t cdata16[1] = {static_cast<char16_t>(0xdf11)};
-    std::u16string str16{cdata16};
+    char16_t cdata16[2] = {static_cast<char16_t>(0xdf11), u'a'};
+    std::u16string str16{cdata16, 2};
     UTFInputIterator it163{std::u16string_view{str16}};
     EXPECT_EQ(*it163, REPLACEMENT_CHARACTER);
     char32_t cdata32[1] = {static_cast<char32_t>(0x001fffff)};
-    std::u32string str32{cdata32};
+    std::u32string str32{cdata32, 1};
     UTFInputIterator it323{std::u32string_view{str32}};
     EXPECT_EQ(*it323, REPLACEMENT_CHARACTER);
 }
@@ -340,15 +404,15 @@ TEST(IteratorTests, UTFInputIterator_decode)
 
     // Invalid characters should return REPLACEMENT_CHARACTER
     char8_t cdata8[1] = {static_cast<char8_t>(0xf9)};
-    std::u8string str8{cdata8};
+    std::u8string str8{cdata8, 1};
     UTFInputIterator it83{std::u8string_view{str8}};
     EXPECT_EQ(it83.Decode(), F(REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_LEAD));
-    char16_t cdata16[1] = {static_cast<char16_t>(0xdf11)};
-    std::u16string str16{cdata16};
+    char16_t cdata16[2] = {static_cast<char16_t>(0xdf11), u'a'};
+    std::u16string str16{cdata16, 2};
     UTFInputIterator it163{std::u16string_view{str16}};
     EXPECT_EQ(it163.Decode(), F(REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_LEAD));
     char32_t cdata32[1] = {static_cast<char32_t>(0x001fffff)};
-    std::u32string str32{cdata32};
+    std::u32string str32{cdata32, 1};
     UTFInputIterator it323{std::u32string_view{str32}};
     EXPECT_EQ(it323.Decode(), F(REPLACEMENT_CHARACTER, UTF_ERROR::INVALID_CODE_POINT));
 }
@@ -429,15 +493,15 @@ TEST(IteratorTests, UTFInputIterator_decode_error)
 
     // Invalid characters
     char8_t cdata8[1] = {static_cast<char8_t>(0xf9)};
-    std::u8string str8{cdata8};
+    std::u8string str8{cdata8, 1};
     UTFInputIterator it83{std::u8string_view{str8}};
     EXPECT_EQ(it83.DecodeError(), UTF_ERROR::INVALID_LEAD);
-    char16_t cdata16[1] = {static_cast<char16_t>(0xdf11)};
-    std::u16string str16{cdata16};
+    char16_t cdata16[2] = {static_cast<char16_t>(0xdf11), u'a'};
+    std::u16string str16{cdata16, 2};
     UTFInputIterator it163{std::u16string_view{str16}};
     EXPECT_EQ(it163.DecodeError(), UTF_ERROR::INVALID_LEAD);
     char32_t cdata32[1] = {static_cast<char32_t>(0x001fffff)};
-    std::u32string str32{cdata32};
+    std::u32string str32{cdata32, 1};
     UTFInputIterator it323{std::u32string_view{str32}};
     EXPECT_EQ(it323.DecodeError(), UTF_ERROR::INVALID_CODE_POINT);
 }
@@ -466,3 +530,203 @@ TEST(IteratorTests, UTFInputIterator_sentinel)
     EXPECT_TRUE(it32 == decltype(it32)::sentinel{});
     EXPECT_TRUE(decltype(it32)::sentinel{} == it32);
 }
+
+TEST(IteratorTests, UTFInputIterator_ascii_runs)
+{
+    using namespace utfcpp;
+    // ASCII runs spanning several vector blocks, interleaved with multi-byte and invalid sequences
+    std::u8string ascii(150, u8'a');
+    std::u8string sv8 = ascii + u8"шницла" + ascii + u8"水手";
+    sv8.push_back(0xfa);
+    sv8.append(ascii);
+    std::u32string ascii32(150, U'a');
+    std::u32string expected = ascii32 + U"шницла" + ascii32 + U"水手" + U'�' + ascii32;
+
+    std::u32string out{};
+    UTFInputIterator it8{std::u8string_view{sv8}};
+    for (; it8 != decltype(it8)::sentinel{}; ++it8) { out.push_back(*it8); }
+    EXPECT_EQ(out, expected);
+
+    // Iterators reaching the same position compare equal regardless of their lookahead
+    UTFInputIterator it_a{std::u8string_view{sv8}};
+    for (int count=0; count < 100; ++count) ++it_a;
+    UTFInputIterator it_b{std::u8string_view{sv8}.substr(100)};
+    EXPECT_TRUE(it_a == it_b);
+    EXPECT_EQ(*it_a, *it_b);
+}
+
+TEST(IteratorTests, UTFBidirectionalIterator_backwards)
+{
+    using namespace utfcpp;
+    static_assert(std::bidirectional_iterator<UTFBidirectionalIterator<char8_t>>);
+    static_assert(std::bidirectional_iterator<UTFBidirectionalIterator<char16_t>>);
+    static_assert(std::bidirectional_iterator<UTFBidirectionalIterator<char32_t>>);
+
+    std::u8string_view sv8{u8"aш水𐌀"};
+    auto it8 = UTFBidirectionalIterator<char8_t>::End(sv8);
+    EXPECT_EQ(*--it8, U'𐌀');
+    EXPECT_EQ(it8.Position(), 6);
+    EXPECT_EQ(*--it8, U'水');
+    EXPECT_EQ(*--it8, U'ш');
+    EXPECT_EQ(*--it8, U'a');
+    EXPECT_TRUE(it8 == UTFBidirectionalIterator<char8_t>{sv8});
+
+    std::u16string_view sv16{u"aш𐌀"};
+    auto it16 = UTFBidirectionalIterator<char16_t>::End(sv16);
+    EXPECT_EQ(*--it16, U'𐌀');
+    EXPECT_EQ(*--it16, U'ш');
+    EXPECT_EQ(*it16--, U'ш');
+    EXPECT_EQ(*it16, U'a');
+}
+
+TEST(IteratorTests, UTFBidirectionalIterator_errors)
+{
+    using namespace utfcpp;
+    // Walking backwards must visit the same code points, errors included, as walking forwards
+    const std::u8string pieces[] = {
+        u8"a", u8"ш", u8"水", u8"𐌀", {0xfa}, {0xc3}, {0xe6, 0x97}, {0xf0, 0x90, 0x8c}, {0xed, 0xa0, 0x80},
+        {0xc0, 0x80}, {0xf4, 0x90, 0x80, 0x80}, {0x80, 0x80, 0x80, 0x80, 0x80}
+    };
+    uint32_t seed = 31;
+    for (int round = 0; round < 500; ++round) {
+        const std::u8string str = RandomUTF(seed, 20, pieces);
+
+        std::vector<std::tuple<size_t, char32_t, UTF_ERROR>> forwards{};
+        UTFBidirectionalIterator<char8_t> it{str};
+        for (; it != UTFBidirectionalIterator<char8_t>::End(str); ++it) {
+            forwards.emplace_back(it.Position(), *it, it.DecodeError());
+        }
+        std::vector<std::tuple<size_t, char32_t, UTF_ERROR>> backwards{};
+        while (it != UTFBidirectionalIterator<char8_t>{str}) {
+            --it;
+            backwards.emplace_back(it.Position(), *it, it.DecodeError());
+        }
+        std::ranges::reverse(backwards);
+        EXPECT_TRUE(forwards == backwards);
+    }
+
+    std::u16string_view sv16{u"\xdc00\xd800\xd800\xdc00\xdc00"};
+    auto it16 = UTFBidirectionalIterator<char16_t>::End(sv16);
+    EXPECT_EQ((--it16).Position(), 4);
+    EXPECT_EQ((--it16).Position(), 2);
+    EXPECT_EQ(*it16, U'\U00010000');
+    EXPECT_EQ((--it16).Position(), 1);
+    EXPECT_EQ((--it16).Position(), 0);
+}
+
+TEST(IteratorTests, UTFLeanIterator_layout)
+{
+    using namespace utfcpp;
+    static_assert(sizeof(UTFLeanIterator<char8_t>) == 2 * sizeof(const char8_t*));
+    static_assert(std::is_trivially_copyable_v<UTFLeanIterator<char8_t>>);
+    static_assert(std::is_trivially_copyable_v<UTFLeanIterator<char16_t>>);
+    static_assert(std::forward_iterator<UTFLeanIterator<char32_t>>);
+
+    std::u8string_view sv8{u8"aш水𐌀"};
+    UTFLeanIterator<char8_t> it{sv8};
+    auto copy = it;
+    EXPECT_TRUE(copy == it);
+    EXPECT_EQ(*++it, U'ш');
+    EXPECT_FALSE(copy == it);
+    EXPECT_TRUE(copy < it);
+    EXPECT_EQ(it.Data(), u8"ш水𐌀");
+}
+
+TEST(IteratorTests, UTFLeanIterator_matches_input_iterator)
+{
+    using namespace utfcpp;
+    const std::u8string pieces[] = {
+        u8"a", u8"ш", u8"水", u8"𐌀", u8"\U0010ffff", u8"퟿", u8"", {0xfa}, {0xc1, 0xbf}, {0xe0, 0x9f, 0xbf},
+        {0xed, 0xa0, 0x80}, {0xf0, 0x8f, 0xbf, 0xbf}, {0xf4, 0x90, 0x80, 0x80}, {0xf5, 0x80, 0x80, 0x80}, {0xe6, 0x97}
+    };
+    uint32_t seed = 4242;
+    for (int round = 0; round < 500; ++round) {
+        const std::u8string str = RandomUTF(seed, 20, pieces);
+
+        UTFInputIterator<char8_t> expected{str};
+        UTFLeanIterator<char8_t> it{str};
+        for (; it != UTFLeanIterator<char8_t>::sentinel{}; ++it, ++expected) {
+            EXPECT_TRUE(it.Data() == expected.Data());
+            EXPECT_EQ(*it, *expected);
+            EXPECT_TRUE(it.DecodeError() == expected.DecodeError());
+        }
+        EXPECT_TRUE(expected == UTFInputIterator<char8_t>::sentinel{});
+
+        std::u16string utf16{};
+        std::ranges::copy(UTFView{std::u8string_view{str}}, CodePointAppender(utf16));
+        if (NextRandom(seed) % 2 && !utf16.empty()) { utf16[NextRandom(seed) % utf16.size()] = 0xd800 + NextRandom(seed) % 0x800; }
+        EXPECT_TRUE((utf8_to_32<UTFLeanIterator>(str)) == utf8_to_32(str));
+        EXPECT_TRUE((utf16_to_32<UTFLeanIterator>(utf16)) == utf16_to_32(utf16));
+        EXPECT_EQ((FindInvalid<char16_t, UTFLeanIterator>(utf16)), FindInvalid<char16_t>(utf16));
+    }
+}
+
+TEST(IteratorTests, UncheckedUTFIterator_valid_input)
+{
+    using namespace utfcpp;
+    static_assert(std::forward_iterator<UncheckedUTFIterator<char8_t>>);
+    static_assert(std::is_trivially_copyable_v<UncheckedUTFIterator<char16_t>>);
+
+    const std::u8string pieces[] = {
+        u8"a", u8"ш", u8"水", u8"𐌀", u8"\U0010ffff", u8"퟿", u8"", u8"\u0080", u8"߿", u8"ࠀ", u8"😀"
+    };
+    uint32_t seed = 1717;
+    for (int round = 0; round < 300; ++round) {
+        const std::u8string str = RandomUTF(seed, 20, pieces);
+        const std::u16string utf16 = utf8_to_16(str);
+        const std::u32string utf32 = utf8_to_32(str);
+
+        EXPECT_TRUE(std::ranges::equal(UTFView<char8_t, UncheckedUTFIterator>{str}, utf32));
+        EXPECT_TRUE(std::ranges::equal(UTFView<char16_t, UncheckedUTFIterator>{utf16}, utf32));
+        EXPECT_TRUE(std::ranges::equal(UTFView<char32_t, UncheckedUTFIterator>{utf32}, utf32));
+        EXPECT_TRUE((utf8_to_16<UncheckedUTFIterator>(str)) == utf16);
+        EXPECT_TRUE((utf16_to_8<UncheckedUTFIterator>(utf16)) == str);
+        EXPECT_TRUE((utf32_to_8<UncheckedUTFIterator>(utf32)) == str);
+        EXPECT_EQ((FindInvalid<char8_t, UncheckedUTFIterator>(str)), str.size());
+    }
+}
+
+TEST(IteratorTests, UncheckedUTFIterator_truncated_input)
+{
+    using namespace utfcpp;
+    // Invalid input decodes to something unspecified, but never past the end
+    std::u8string truncated{{0x61, 0xf0, 0x90}};
+    UncheckedUTFIterator<char8_t> it{truncated};
+    EXPECT_EQ(*it, U'a');
+    ++it;
+    EXPECT_EQ(it.Data().size(), 2);
+    ++it;
+    EXPECT_TRUE(it == UncheckedUTFIterator<char8_t>::sentinel{});
+
+    std::u16string lone_lead{{0x0061, 0xd800}};
+    EXPECT_EQ(std::ranges::distance(UncheckedUTFIterator<char16_t>{lone_lead}, UncheckedUTFIterator<char16_t>::sentinel{}), 2);
+}
+
+TEST(IteratorTests, UTFDFAIterator_matches_input_iterator)
+{
+    using namespace utfcpp;
+    static_assert(std::forward_iterator<UTFDFAIterator<char8_t>>);
+
+    const std::u8string pieces[] = {
+        u8"a", u8"ш", u8"水", u8"𐌀", u8"\U0010ffff", u8"퟿", u8"", {0xfa}, {0xc1, 0xbf}, {0xe0, 0x9f, 0xbf},
+        {0xed, 0xa0, 0x80}, {0xf0, 0x8f, 0xbf, 0xbf}, {0xf4, 0x90, 0x80, 0x80}, {0xf5, 0x80, 0x80, 0x80}, {0xe6, 0x97}
+    };
+    uint32_t seed = 9191;
+    for (int round = 0; round < 500; ++round) {
+        const std::u8string str = RandomUTF(seed, 20, pieces);
+
+        UTFInputIterator<char8_t> expected{str};
+        UTFDFAIterator<char8_t> it{str};
+        for (; it != UTFDFAIterator<char8_t>::sentinel{}; ++it, ++expected) {
+            EXPECT_TRUE(it.Data() == expected.Data());
+            EXPECT_EQ(*it, *expected);
+            EXPECT_TRUE(it.DecodeError() == expected.DecodeError());
+        }
+        EXPECT_TRUE(expected == UTFInputIterator<char8_t>::sentinel{});
+
+        const std::u16string utf16 = utf8_to_16(str);
+        EXPECT_TRUE((utf8_to_32<UTFDFAIterator>(str)) == utf8_to_32(str));
+        EXPECT_TRUE((utf16_to_32<UTFDFAIterator>(utf16)) == utf16_to_32(utf16));
+        EXPECT_EQ((FindInvalid<char8_t, UTFDFAIterator>(str)), FindInvalid<char8_t>(str));
+    }
+}
@@ -0,0 +1,121 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <algorithm>
+#include <string>
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+
+// Every byte value in order, repeated so that vector blocks and scalar tails are both exercised
+static std::string AllBytes(size_t repeat)
+{
+    std::string bytes{};
+    for (size_t r = 0; r < repeat; ++r) {
+        for (unsigned b = 0; b < 0x100; ++b) { bytes.push_back(static_cast<char>(b)); }
+    }
+    return bytes;
+}
+
+TEST(Latin1Tests, test_IsASCII)
+{
+    using namespace utfcpp;
+    EXPECT_TRUE(IsASCII(std::string_view{}));
+    std::u16string ascii16(100, u'a');
+    std::u32string ascii32(100, U'z');
+    std::string ascii8(100, 'q');
+    EXPECT_TRUE(IsASCII<char16_t>(ascii16));
+    EXPECT_TRUE(IsASCII<char32_t>(ascii32));
+    EXPECT_TRUE(IsASCII<char>(ascii8));
+    EXPECT_TRUE(IsASCII<char8_t>(u8"plain text"));
+    for (size_t pos : {0, 15, 31, 63, 64, 99}) {
+        std::u16string s16 = ascii16;
+        s16[pos] = u'\x80';
+        EXPECT_FALSE(IsASCII<char16_t>(s16));
+        s16[pos] = u'\x100';
+        EXPECT_FALSE(IsASCII<char16_t>(s16));
+        std::u32string s32 = ascii32;
+        s32[pos] = 0x10000;
+        EXPECT_FALSE(IsASCII<char32_t>(s32));
+        std::string s8 = ascii8;
+        s8[pos] = static_cast<char>(0xe9);
+        EXPECT_FALSE(IsASCII<char>(s8));
+    }
+    static_assert(IsASCII(std::u16string_view{u"abc"}));
+    static_assert(!IsASCII(std::u32string_view{U"abç"}));
+}
+
+TEST(Latin1Tests, test_from_latin1)
+{
+    using namespace utfcpp;
+    EXPECT_TRUE(latin1_to_8("caf\xe9") == u8"café");
+    EXPECT_TRUE(latin1_to_16("caf\xe9") == u"café");
+    EXPECT_TRUE(latin1_to_32("caf\xe9") == U"café");
+    EXPECT_TRUE(latin1_to_8("").empty());
+
+    // Reference: one code point per byte through Latin1View
+    for (size_t repeat : {1, 3}) {
+        const std::string bytes = AllBytes(repeat);
+        std::u32string expected{};
+        std::ranges::copy(Latin1View(bytes), CodePointAppender(expected));
+        EXPECT_EQ(expected.size(), bytes.size());
+        EXPECT_TRUE(latin1_to_32(bytes) == expected);
+        EXPECT_TRUE(latin1_to_16(bytes) == utf32_to_16(expected));
+        EXPECT_TRUE(latin1_to_8(bytes) == utf32_to_8(expected));
+        EXPECT_EQ(Latin1EncodedLength<char8_t>(bytes), utf32_to_8(expected).size());
+    }
+    static_assert(Latin1ConvertTo<char16_t>("\xfc").front() == u'ü');
+    static_assert(Latin1EncodedLength<char8_t>("a\xff") == 3);
+}
+
+TEST(Latin1Tests, test_to_latin1)
+{
+    using namespace utfcpp;
+    EXPECT_TRUE(utf8_to_latin1(u8"café") == "caf\xe9");
+    EXPECT_TRUE(utf16_to_latin1(u"café 水") == "caf\xe9 ?");
+    EXPECT_TRUE(utf32_to_latin1(U"𐌀x", '*') == "*x");
+
+    // Invalid input decodes as in UTFView; each REPLACEMENT_CHARACTER becomes one replacement byte
+    std::u8string invalid8{u8"a"};
+    invalid8.append({0xfa, 0xe6, 0x97});
+    invalid8.append(u8"é");
+    EXPECT_TRUE(utf8_to_latin1(invalid8) == "a???\xe9");
+    std::u16string invalid16{{0x61, 0xd800, 0x62, 0xdc00}};
+    EXPECT_TRUE(utf16_to_latin1(invalid16) == "a?b?");
+    std::u8string long_invalid8{};
+    std::string long_expected{};
+    for (int i = 0; i < 20; ++i) {
+        long_invalid8 += invalid8;
+        long_expected += "a???\xe9";
+    }
+    EXPECT_TRUE(utf8_to_latin1(long_invalid8) == long_expected);
+
+    // Round trips of every byte value, through vector blocks and scalar tails
+    for (size_t repeat : {1, 3}) {
+        const std::string bytes = AllBytes(repeat);
+        EXPECT_TRUE(utf8_to_latin1(latin1_to_8(bytes)) == bytes);
+        EXPECT_TRUE(utf16_to_latin1(latin1_to_16(bytes)) == bytes);
+        EXPECT_TRUE(utf32_to_latin1(latin1_to_32(bytes)) == bytes);
+    }
+
+    // Blocks mixing narrow code units with wide ones and surrogate pairs
+    std::u32string mixed{};
+    for (int i = 0; i < 200; ++i) { mixed.push_back(i % 7 == 3 ? U'水' : (i % 11 == 5 ? U'𐌀' : static_cast<char32_t>(0xa0 + i % 90))); }
+    std::string expected{};
+    for (char32_t code_point : mixed) { expected.push_back(code_point <= 0xff ? static_cast<char>(code_point) : '?'); }
+    EXPECT_TRUE(utf32_to_latin1(mixed) == expected);
+    EXPECT_TRUE(utf16_to_latin1(utf32_to_16(mixed)) == expected);
+    EXPECT_TRUE(utf8_to_latin1(utf32_to_8(mixed)) == expected);
+    static_assert(UTFConvertToLatin1<char16_t>(u"ÿ水") == "\xff?");
+}
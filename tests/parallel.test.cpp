@@ -0,0 +1,69 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include <memory_resource>
+#include <vector>
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+#include "test_helpers.hpp"
+
+// Several chunks' worth of text, with code points and invalid sequences straddling the chunk boundaries.
+static std::u8string LargeUTF8()
+{
+    const std::u8string pieces[] = {
+        u8"abc", u8"шницла", u8"水手", u8"𐌀", u8"😀", {0xfa}, {0xe6, 0x97}, {0xf0, 0x90, 0x8c}, {0xed, 0xa0, 0x80}
+    };
+    uint32_t seed = 99;
+    std::u8string str{};
+    while (str.size() < 5 * utfcpp::PARALLEL_MIN_CHUNK) {
+        str.append(RandomUTF(seed, 64, pieces, {.valid_count = 5, .invalid_odds = 64}));
+    }
+    return str;
+}
+
+TEST(ParallelTests, test_small_input)
+{
+    using namespace utfcpp;
+    EXPECT_EQ((UTFConvertToParallel<char8_t, char16_t>(u8"", 4)), u"");
+    EXPECT_EQ((UTFConvertToParallel<char8_t, char16_t>(u8"abcdxyzшницла水手𐌀", 4)), u"abcdxyzшницла水手𐌀");
+}
+
+TEST(ParallelTests, test_matches_serial)
+{
+    using namespace utfcpp;
+    const std::u8string utf8 = LargeUTF8();
+    const std::u16string utf16 = utf8_to_16(utf8);
+    const std::u32string utf32 = utf8_to_32(utf8);
+    for (size_t threads : {2, 3, 5, 8}) {
+        EXPECT_TRUE((UTFConvertToParallel<char8_t, char8_t>(utf8, threads)) == utf8_to_8(utf8));
+        EXPECT_TRUE((UTFConvertToParallel<char8_t, char16_t>(utf8, threads)) == utf16);
+        EXPECT_TRUE((UTFConvertToParallel<char8_t, char32_t>(utf8, threads)) == utf32);
+        EXPECT_TRUE((UTFConvertToParallel<char16_t, char8_t>(utf16, threads)) == utf16_to_8(utf16));
+        EXPECT_TRUE((UTFConvertToParallel<char32_t, char16_t>(utf32, threads)) == utf16);
+    }
+}
+
+TEST(ParallelTests, test_allocator)
+{
+    using namespace utfcpp;
+    // The arena cannot grow, so the result must come from buffer
+    const std::u8string utf8 = LargeUTF8();
+    std::vector<std::byte> buffer(4 * utf8.size());
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(), std::pmr::null_memory_resource()};
+    std::pmr::u16string utf16 =
+        UTFConvertToParallel<char8_t, char16_t>(utf8, 4, std::pmr::polymorphic_allocator<char16_t>{&arena});
+    EXPECT_TRUE(std::u16string_view{utf16} == utf8_to_16(utf8));
+    const auto* data = reinterpret_cast<const std::byte*>(utf16.data());
+    EXPECT_TRUE(data >= buffer.data() && data < buffer.data() + buffer.size());
+}
@@ -0,0 +1,147 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#include "utfcpp/utfcpp.hpp"
+#include "ftest.h"
+#include "test_helpers.hpp"
+
+// Feeds src in chunks of chunk_size through buffers of buffer_size code units and collects the output.
+template <typename Src_t, typename Dst_t>
+static std::basic_string<Dst_t> TranscodeInChunks(std::basic_string_view<Src_t> src, size_t chunk_size, size_t buffer_size)
+{
+    using namespace utfcpp;
+    StreamTranscoder<Src_t, Dst_t> transcoder{};
+    std::basic_string<Dst_t> output{};
+    std::basic_string<Dst_t> buffer(buffer_size, Dst_t{});
+    while (!src.empty()) {
+        std::basic_string_view<Src_t> chunk = src.substr(0, chunk_size);
+        src.remove_prefix(chunk.size());
+        while (true) {
+            TranscodeResult result = transcoder.Transcode(chunk, buffer);
+            output.append(buffer.data(), result.produced);
+            chunk.remove_prefix(result.consumed);
+            if (result.error_code == UTF_ERROR::OK) { break; }
+        }
+    }
+    while (true) {
+        TranscodeResult result = transcoder.Finish(buffer);
+        output.append(buffer.data(), result.produced);
+        if (result.error_code == UTF_ERROR::OK) { break; }
+    }
+    return output;
+}
+
+TEST(StreamTests, test_split_utf8)
+{
+    using namespace utfcpp;
+    StreamTranscoder<char8_t, char16_t> transcoder{};
+    char16_t buffer[8]{};
+
+    // 水 is e6 b0 b4; each call gets one byte
+    TranscodeResult result = transcoder.Transcode(u8"a\xe6", buffer);
+    EXPECT_EQ(result.consumed, 2);
+    EXPECT_EQ(result.produced, 1);
+    EXPECT_EQ(buffer[0], u'a');
+    EXPECT_EQ(transcoder.Pending().size(), 1);
+    result = transcoder.Transcode(u8"\xb0", buffer);
+    EXPECT_EQ(result.consumed, 1);
+    EXPECT_EQ(result.produced, 0);
+    EXPECT_EQ(transcoder.Pending().size(), 2);
+    result = transcoder.Transcode(u8"\xb4z", buffer);
+    EXPECT_EQ(result.consumed, 2);
+    EXPECT_EQ(result.produced, 2);
+    EXPECT_EQ(buffer[0], u'水');
+    EXPECT_EQ(buffer[1], u'z');
+    EXPECT_TRUE(transcoder.Pending().empty());
+    EXPECT_EQ(transcoder.Finish(buffer).produced, 0);
+}
+
+TEST(StreamTests, test_split_utf16)
+{
+    using namespace utfcpp;
+    StreamTranscoder<char16_t, char8_t> transcoder{};
+    char8_t buffer[8]{};
+
+    // 𐌀 is d800 df00
+    TranscodeResult result = transcoder.Transcode(u"\xd800", buffer);
+    EXPECT_EQ(result.consumed, 1);
+    EXPECT_EQ(result.produced, 0);
+    result = transcoder.Transcode(u"\xdf00", buffer);
+    EXPECT_EQ(result.consumed, 1);
+    EXPECT_EQ(result.produced, 4);
+    EXPECT_EQ(std::u8string(buffer, 4), u8"𐌀");
+}
+
+TEST(StreamTests, test_finish)
+{
+    using namespace utfcpp;
+    StreamTranscoder<char8_t, char32_t> transcoder{};
+    char32_t buffer[4]{};
+
+    // A truncated sequence at the end of the stream becomes one REPLACEMENT_CHARACTER per byte
+    TranscodeResult result = transcoder.Transcode(u8"\xf0\x90\x8c", buffer);
+    EXPECT_EQ(result.consumed, 3);
+    EXPECT_EQ(result.produced, 0);
+    result = transcoder.Finish(buffer);
+    EXPECT_EQ(result.produced, 3);
+    EXPECT_EQ(std::u32string(buffer, 3), U"���");
+    EXPECT_TRUE(transcoder.Pending().empty());
+
+    // A pending sequence followed by something other than its trail bytes
+    transcoder.Transcode(u8"\xe6\x97", buffer);
+    result = transcoder.Transcode(u8"a", buffer);
+    EXPECT_EQ(result.consumed, 1);
+    EXPECT_EQ(result.produced, 3);
+    EXPECT_EQ(std::u32string(buffer, 3), U"��a");
+}
+
+TEST(StreamTests, test_not_enough_room)
+{
+    using namespace utfcpp;
+    StreamTranscoder<char8_t, char8_t> transcoder{};
+    char8_t buffer[4]{};
+
+    TranscodeResult result = transcoder.Transcode(u8"ab水", buffer);
+    EXPECT_EQ(result.consumed, 2);
+    EXPECT_EQ(result.produced, 2);
+    EXPECT_TRUE(result.error_code == UTF_ERROR::NOT_ENOUGH_ROOM);
+    result = transcoder.Transcode(u8"水", buffer);
+    EXPECT_EQ(result.consumed, 3);
+    EXPECT_EQ(result.produced, 3);
+    EXPECT_TRUE(result.error_code == UTF_ERROR::OK);
+}
+
+TEST(StreamTests, test_chunks)
+{
+    using namespace utfcpp;
+    const std::u8string pieces[] = {
+        u8"a", u8"xyz", u8"ш", u8"水", u8"𐌀", u8"\U0010ffff", u8"шницла", u8"水手水手水手", std::u8string(40, u8'a'),
+        {0xfa}, {0xc0, 0x80}, {0xed, 0xa0, 0x80}, {0xf4, 0x90, 0x80, 0x80}, {0xff}, {0xe6, 0x97}, {0xf0, 0x90, 0x8c}
+    };
+    uint32_t seed = 777;
+    for (int round = 0; round < 500; ++round) {
+        const std::u8string str = RandomUTF(seed, 50, pieces);
+        const size_t chunk_size = 1 + NextRandom(seed) % 20;
+        const size_t buffer_size = 4 + NextRandom(seed) % 40;
+
+        const std::u16string utf16 = utf8_to_16(str);
+        const std::u32string utf32 = utf8_to_32(str);
+        EXPECT_EQ((TranscodeInChunks<char8_t, char8_t>(str, chunk_size, buffer_size)), utf8_to_8(str));
+        EXPECT_EQ((TranscodeInChunks<char8_t, char16_t>(str, chunk_size, buffer_size)), utf16);
+        EXPECT_EQ((TranscodeInChunks<char8_t, char32_t>(str, chunk_size, buffer_size)), utf32);
+        EXPECT_EQ((TranscodeInChunks<char16_t, char8_t>(utf16, chunk_size, buffer_size)), utf16_to_8(utf16));
+        EXPECT_EQ((TranscodeInChunks<char16_t, char32_t>(utf16, chunk_size, buffer_size)), utf32);
+        EXPECT_EQ((TranscodeInChunks<char32_t, char16_t>(utf32, chunk_size, buffer_size)), utf16);
+    }
+}
@@ -0,0 +1,68 @@
+//    Copyright 2024 Nemanja Trifunovic
+
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+
+//        http://www.apache.org/licenses/LICENSE-2.0
+
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Linear congruential generator, so that every run of a test sees the same input.
+inline uint32_t NextRandom(uint32_t& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7fff;
+}
+
+// How RandomUTF picks its pieces. Those from valid_count on, meant to be the invalid ones, are picked only
+// one time in invalid_odds, and one time in run_odds a piece is repeated into a run of up to 39 code units.
+struct RandomMix {
+    size_t valid_count{SIZE_MAX};
+    uint32_t invalid_odds{1};
+    uint32_t run_odds{0};
+};
+
+// Fewer than max_pieces pieces picked at random and concatenated.
+template <typename T, size_t N>
+std::basic_string<T> RandomUTF(uint32_t& seed, size_t max_pieces, const std::basic_string<T> (&pieces)[N], RandomMix mix = {})
+{
+    std::basic_string<T> str{};
+    const size_t count = NextRandom(seed) % max_pieces;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t choices = NextRandom(seed) % mix.invalid_odds ? std::min(mix.valid_count, N) : N;
+        const std::basic_string<T>& piece = pieces[NextRandom(seed) % choices];
+        const bool run = mix.run_odds && NextRandom(seed) % mix.run_odds == 0;
+        const size_t repeat = run ? NextRandom(seed) % 40 / std::max<size_t>(piece.size(), 1) : 1;
+        for (size_t r = 0; r < repeat; ++r) { str.append(piece); }
+    }
+    return str;
+}
+
+// The code units of str in byte order Order, after skip bytes of padding.
+template <typename T>
+std::vector<std::byte> Serialize(std::basic_string_view<T> str, std::endian order, size_t skip = 0)
+{
+    std::vector<std::byte> bytes(skip);
+    for (T unit : str) {
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            const size_t shift = order == std::endian::little ? 8 * i : 8 * (sizeof(T) - 1 - i);
+            bytes.push_back(static_cast<std::byte>(static_cast<uint32_t>(unit) >> shift));
+        }
+    }
+    return bytes;
+}
@@ -12,8 +12,10 @@
 //    See the License for the specific language governing permissions and
 //    limitations under the License.
 
+#include <deque>
 #include "utfcpp/utfcpp.hpp"
 #include "ftest.h"
+#include "test_helpers.hpp"
 
 TEST(UtilityTests, test_FindInvalid)
 {
@@ -45,6 +47,49 @@ TEST(UtilityTests, test_FindInvalid)
     EXPECT_EQ(FindInvalid<char16_t>(invalid4), 2);
     EXPECT_EQ(FindInvalid<char32_t>(invalid5), 2);
     EXPECT_EQ(FindInvalid<char32_t>(invalid6), 2);
+
+    // Errors following ASCII runs longer than a vector block
+    std::u8string long_ascii(200, u8'a');
+    EXPECT_EQ(FindInvalid<char8_t>(long_ascii), long_ascii.size());
+    std::u8string long_invalid = long_ascii + u8"шницла" + long_ascii;
+    long_invalid.push_back(0xfa);
+    long_invalid.append(long_ascii);
+    EXPECT_EQ(FindInvalid<char8_t>(long_invalid), 2 * long_ascii.size() + 12);
+}
+
+// Pseudo-random utf-8 built from valid pieces and the occasional invalid one, long enough to cross vector blocks.
+static std::u8string RandomUTF8(uint32_t& seed, size_t max_pieces)
+{
+    static const std::u8string pieces[] = {
+        u8"a", u8"xyz", u8"ш", u8"水", u8"𐌀", u8"\U0010ffff", u8"\ud7ff", u8"\ue000",
+        u8"шницла", u8"水手水手水手", u8"é",
+        {0xfa}, {0xc0, 0x80}, {0xc1, 0xbf}, {0xe0, 0x80, 0x80}, {0xe0, 0x9f, 0xbf}, {0xed, 0xa0, 0x80},
+        {0xf0, 0x8f, 0xbf, 0xbf}, {0xf4, 0x90, 0x80, 0x80}, {0xf5, 0x80, 0x80, 0x80}, {0xff},
+        {0x80}, {0xe6, 0x97}, {0xf0, 0x90, 0x8c}, {0xc3, 0xc3}
+    };
+    return RandomUTF(seed, max_pieces, pieces, {.valid_count = 11, .invalid_odds = 8, .run_odds = 4});
+}
+
+TEST(UtilityTests, test_FindInvalid_blocks)
+{
+    using namespace utfcpp;
+    // Reference: first error reported by DecodeUTF8 walking the input one code point at a time
+    auto reference = [](std::u8string_view sv) -> size_t {
+        size_t pos = 0;
+        while (pos < sv.size()) {
+            DecodeData data = DecodeUTF8(sv.substr(pos));
+            if (data.error_code != UTF_ERROR::OK) { return pos; }
+            pos += data.consumed;
+        }
+        return pos;
+    };
+
+    uint32_t seed = 12345;
+    for (int round = 0; round < 2000; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        EXPECT_EQ(FindInvalid<char8_t>(str), reference(str));
+        EXPECT_EQ(IsValid<char8_t>(str), reference(str) == str.size());
+    }
 }
 
 TEST(UtilityTests, test_is_invalid)
@@ -79,6 +124,144 @@ TEST(UtilityTests, test_is_invalid)
     EXPECT_FALSE(IsValid<char32_t>(invalid6));
 }
 
+TEST(UtilityTests, test_EncodedLength)
+{
+    using namespace utfcpp;
+    EXPECT_EQ(EncodedLength<char8_t>(std::u8string_view{}), 0);
+    EXPECT_EQ(EncodedLength<char16_t>(std::u16string_view{}), 0);
+    EXPECT_EQ(EncodedLength<char32_t>(std::u32string_view{}), 0);
+
+    std::u8string_view sv8{u8"abcdxyzшницла水手𐌀"};
+    std::u16string_view sv16{u"abcdxyzшницла水手𐌀"};
+    std::u32string_view sv32{U"abcdxyzшницла水手𐌀"};
+    EXPECT_EQ(EncodedLength<char8_t>(sv8), sv8.size());
+    EXPECT_EQ(EncodedLength<char16_t>(sv8), sv16.size());
+    EXPECT_EQ(EncodedLength<char32_t>(sv8), sv32.size());
+    EXPECT_EQ(EncodedLength<char8_t>(sv16), sv8.size());
+    EXPECT_EQ(EncodedLength<char16_t>(sv16), sv16.size());
+    EXPECT_EQ(EncodedLength<char32_t>(sv16), sv32.size());
+    EXPECT_EQ(EncodedLength<char8_t>(sv32), sv8.size());
+    EXPECT_EQ(EncodedLength<char16_t>(sv32), sv16.size());
+    EXPECT_EQ(EncodedLength<char32_t>(sv32), sv32.size());
+
+    // Invalid input is counted as the REPLACEMENT_CHARACTERs it turns into
+    std::u8string invalid8{{0xe6, 0x97, 0xa5, 0xd1, 0x88, 0xfa, 0xe6, 0x97}};
+    EXPECT_EQ(EncodedLength<char8_t>(std::u8string_view{invalid8}), utf8_to_8(invalid8).size());
+    EXPECT_EQ(EncodedLength<char16_t>(std::u8string_view{invalid8}), utf8_to_16(invalid8).size());
+    EXPECT_EQ(EncodedLength<char32_t>(std::u8string_view{invalid8}), utf8_to_32(invalid8).size());
+    std::u16string invalid16{{0xdc07, 0x65e5, 0xd800, 0xd800, 0xdc00, 0xd800}};
+    EXPECT_EQ(EncodedLength<char8_t>(std::u16string_view{invalid16}), utf16_to_8(invalid16).size());
+    EXPECT_EQ(EncodedLength<char32_t>(std::u16string_view{invalid16}), utf16_to_32(invalid16).size());
+    std::u32string invalid32{{0x0000d800, 0x0011ffff, 0x0001f600}};
+    EXPECT_EQ(EncodedLength<char8_t>(std::u32string_view{invalid32}), utf32_to_8(invalid32).size());
+    EXPECT_EQ(EncodedLength<char16_t>(std::u32string_view{invalid32}), utf32_to_16(invalid32).size());
+}
+
+TEST(UtilityTests, test_CountCodePoints)
+{
+    using namespace utfcpp;
+    EXPECT_EQ(CountCodePoints(std::u8string_view{}), 0);
+    EXPECT_EQ(CountCodePoints(std::u16string_view{}), 0);
+    EXPECT_EQ(CountCodePoints(std::u32string_view{}), 0);
+
+    std::u8string_view sv8{u8"abcdxyzшницла水手𐌀"};
+    std::u16string_view sv16{u"abcdxyzшницла水手𐌀"};
+    std::u32string_view sv32{U"abcdxyzшницла水手𐌀"};
+    EXPECT_EQ(CountCodePoints(sv8), sv32.size());
+    EXPECT_EQ(CountCodePoints(sv16), sv32.size());
+    EXPECT_EQ(CountCodePoints(sv32), sv32.size());
+    EXPECT_EQ(CountCodePoints(UTFView{sv8}), sv32.size());
+    EXPECT_EQ(CountCodePoints(UTFView<char8_t, UTFBidirectionalIterator>{sv8}), sv32.size());
+
+    // Every invalid code unit is a code point of its own
+    std::u8string invalid8{{0xe6, 0x97, 0xa5, 0xd1, 0x88, 0xfa, 0xe6, 0x97}};
+    EXPECT_EQ(CountCodePoints<char8_t>(invalid8), 5);
+    std::u16string invalid16{{0xdc07, 0x65e5, 0xd800, 0xd800, 0xdc00, 0xd800}};
+    EXPECT_EQ(CountCodePoints<char16_t>(invalid16), 5);
+
+    uint32_t seed = 4242;
+    for (int round = 0; round < 500; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        UTFView view{std::u8string_view{str}};
+        EXPECT_EQ(CountCodePoints<char8_t>(str), static_cast<size_t>(std::ranges::distance(view.begin(), view.end())));
+    }
+}
+
+TEST(UtilityTests, test_CodePointOffset)
+{
+    using namespace utfcpp;
+    std::u8string_view sv8{u8"aш水𐌀b"};
+    std::u16string_view sv16{u"aш水𐌀b"};
+    std::u32string_view sv32{U"aш水𐌀b"};
+    const size_t offsets8[] = {0, 1, 3, 6, 10, 11, 11};
+    const size_t offsets16[] = {0, 1, 2, 3, 5, 6, 6};
+    for (size_t n = 0; n < std::size(offsets8); ++n) {
+        EXPECT_EQ(CodePointOffset(sv8, n), offsets8[n]);
+        EXPECT_EQ(CodePointOffset(sv16, n), offsets16[n]);
+        EXPECT_EQ(CodePointOffset(sv32, n), std::min(n, sv32.size()));
+    }
+    EXPECT_EQ(CodePointOffset(sv8, static_cast<size_t>(-1)), sv8.size());
+
+    EXPECT_TRUE(std::ranges::equal(Advance(UTFView{sv8}, 2), UTFView{sv32.substr(2)}));
+    EXPECT_TRUE(std::ranges::equal(Advance(UTFView<char16_t, UTFLeanIterator>{sv16}, 3), UTFView{sv32.substr(3)}));
+    EXPECT_TRUE(Advance(UTFView{sv8}, 5).empty());
+
+    // Reference: n steps of UTFView; long strings go through the block skipping path
+    uint32_t seed = 777;
+    for (int round = 0; round < 200; ++round) {
+        std::u8string str = RandomUTF8(seed, round % 10 ? 60 : 400);
+        UTFView view{std::u8string_view{str}};
+        auto iter = view.begin();
+        for (size_t n = 0; ; ++n) {
+            EXPECT_EQ(CodePointOffset<char8_t>(str, n), str.size() - iter.Data().size());
+            if (iter == view.end()) { break; }
+            ++iter;
+        }
+    }
+}
+
+TEST(UtilityTests, test_DecodeBlock)
+{
+    using namespace utfcpp;
+    char32_t out[4]{};
+    TranscodeResult result = DecodeBlock<char8_t>(u8"aш水𐌀b", out);
+    EXPECT_EQ(result.consumed, size_t{10});
+    EXPECT_EQ(result.produced, size_t{4});
+    EXPECT_EQ(result.error_code, UTF_ERROR::OK);
+    EXPECT_EQ(std::u32string_view(out, 4), U"aш水𐌀");
+    result = DecodeBlock<char16_t>(u"a\xdc00" u"b", out);
+    EXPECT_EQ(result.consumed, size_t{3});
+    EXPECT_EQ(result.produced, size_t{3});
+    EXPECT_EQ(result.error_code, UTF_ERROR::INVALID_LEAD);
+    EXPECT_EQ(DecodeBlock<char32_t>(U"ab", std::span<char32_t>{}).consumed, size_t{0});
+
+    // Reference: UTFView, consumed in blocks of several sizes
+    uint32_t seed = 4242;
+    for (int round = 0; round < 500; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        std::u32string expected{};
+        std::ranges::copy(UTFView{std::u8string_view{str}}, CodePointAppender(expected));
+        const size_t invalid = FindInvalid<char8_t>(str);
+        const UTF_ERROR first_error = invalid < str.size() ?
+            detail::DecodeOne(std::u8string_view{str}.substr(invalid)).error_code : UTF_ERROR::OK;
+        for (size_t block_size : {1, 3, 16, 100}) {
+            std::u32string decoded(block_size, U'\0');
+            std::u32string actual{};
+            UTF_ERROR error_code = UTF_ERROR::OK;
+            std::u8string_view rest{str};
+            while (!rest.empty()) {
+                result = DecodeBlock(rest, std::span<char32_t>{decoded});
+                EXPECT_TRUE(result.produced > 0 && result.produced <= block_size);
+                if (error_code == UTF_ERROR::OK) { error_code = result.error_code; }
+                actual.append(decoded, 0, result.produced);
+                rest.remove_prefix(result.consumed);
+            }
+            EXPECT_EQ(actual, expected);
+            EXPECT_EQ(error_code, first_error);
+        }
+    }
+}
+
 /***
  * Test UTFConvertTo
  * NOTE: Need to include more codepoints that test u16 surrogate values.
@@ -98,6 +281,9 @@ TEST(UtilityTests, test_utf8_to_8)
     std::u8string invalid2{{0xe6, 0x97, 0xa5, 0xd1, 0x88, 0xfa, 0xe6, 0x97, 0xa5}};
     std::u8string final2{{0xe6, 0x97, 0xa5, 0xd1, 0x88, 0xef, 0xbf, 0xbd, 0xe6, 0x97, 0xa5}};
     EXPECT_EQ(utf8_to_8(invalid2), final2);
+
+    std::u8string long_ascii(200, u8'a');
+    EXPECT_EQ(utf8_to_8(long_ascii + u8"水手" + long_ascii), long_ascii + u8"水手" + long_ascii);
 }
 
 TEST(UtilityTests, test_utf8_to_16)
@@ -118,6 +304,18 @@ TEST(UtilityTests, test_utf8_to_16)
     EXPECT_EQ(utf8_to_16(invalid2), final2);
 }
 
+TEST(UtilityTests, test_utf8_to_16_blocks)
+{
+    using namespace utfcpp;
+    uint32_t seed = 54321;
+    for (int round = 0; round < 2000; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        std::u16string expected{};
+        std::ranges::copy(UTFView{std::u8string_view{str}}, CodePointAppender(expected));
+        EXPECT_EQ(utf8_to_16(str), expected);
+    }
+}
+
 TEST(UtilityTests, test_utf8_to_32)
 {
     using namespace utfcpp;
@@ -136,6 +334,18 @@ TEST(UtilityTests, test_utf8_to_32)
     EXPECT_EQ(utf8_to_32(invalid2), final2);
 }
 
+TEST(UtilityTests, test_utf8_to_32_blocks)
+{
+    using namespace utfcpp;
+    uint32_t seed = 65432;
+    for (int round = 0; round < 2000; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        std::u32string expected{};
+        std::ranges::copy(UTFView{std::u8string_view{str}}, CodePointAppender(expected));
+        EXPECT_EQ(utf8_to_32(str), expected);
+    }
+}
+
 TEST(UtilityTests, test_utf16_to_8)
 {
     using namespace utfcpp;
@@ -154,6 +364,50 @@ TEST(UtilityTests, test_utf16_to_8)
     EXPECT_EQ(utf16_to_8(invalid2), final2);
 }
 
+// Pseudo-random utf-16 with the occasional unpaired surrogate.
+static std::u16string RandomUTF16(uint32_t& seed, size_t max_pieces)
+{
+    static const std::u16string pieces[] = {
+        u"a", u"xyz", u"é", u"шницла", u"水手", u"𐌀", u"😀😀", u"\U0010ffff", u"\ud7ff", u"\ue000", u"\uffff",
+        {0xd800}, {0xdc00}, {0xdbff, 0x0041}, {0xdc00, 0xd800}
+    };
+    return RandomUTF(seed, max_pieces, pieces, {.valid_count = 11, .invalid_odds = 8, .run_odds = 4});
+}
+
+// Pseudo-random utf-32 with the occasional surrogate or out of range value.
+static std::u32string RandomUTF32(uint32_t& seed, size_t max_pieces)
+{
+    static const std::u32string pieces[] = {
+        U"a", U"xyz", U"é", U"шницла", U"水手", U"𐌀", U"😀😀", U"\U0010ffff", U"\ud7ff", U"\ue000", U"\uffff",
+        {0xd800}, {0xdfff}, {0x110000}, {0xffffffff}
+    };
+    return RandomUTF(seed, max_pieces, pieces, {.valid_count = 11, .invalid_odds = 8, .run_odds = 4});
+}
+
+TEST(UtilityTests, test_utf16_to_8_blocks)
+{
+    using namespace utfcpp;
+    uint32_t seed = 2024;
+    for (int round = 0; round < 2000; ++round) {
+        std::u16string str = RandomUTF16(seed, 60);
+        std::u8string expected{};
+        std::ranges::copy(UTFView{std::u16string_view{str}}, CodePointAppender(expected));
+        EXPECT_EQ(utf16_to_8(str), expected);
+    }
+}
+
+TEST(UtilityTests, test_utf16_to_32_blocks)
+{
+    using namespace utfcpp;
+    uint32_t seed = 4096;
+    for (int round = 0; round < 2000; ++round) {
+        std::u16string str = RandomUTF16(seed, 60);
+        std::u32string expected{};
+        std::ranges::copy(UTFView{std::u16string_view{str}}, CodePointAppender(expected));
+        EXPECT_EQ(utf16_to_32(str), expected);
+    }
+}
+
 TEST(UtilityTests, test_utf16_to_16)
 {
     using namespace utfcpp;
@@ -243,3 +497,203 @@ TEST(UtilityTests, test_utf32_to_32)
     std::u32string final2{{0x000065e5, 0x00000448, 0x0000fffd, 0x000065e5, 0x00000448}};
     EXPECT_EQ(utf32_to_32(invalid2), final2);
 }
+
+TEST(UtilityTests, test_utf32_blocks)
+{
+    using namespace utfcpp;
+    uint32_t seed = 8192;
+    for (int round = 0; round < 2000; ++round) {
+        std::u32string str = RandomUTF32(seed, 60);
+        const size_t first_invalid = std::ranges::find_if_not(str, is_code_point_valid) - str.begin();
+        EXPECT_EQ(FindInvalid<char32_t>(str), first_invalid);
+
+        std::u8string expected8{};
+        std::u16string expected16{};
+        std::u32string expected32{};
+        std::ranges::copy(UTFView{std::u32string_view{str}}, CodePointAppender(expected8));
+        std::ranges::copy(UTFView{std::u32string_view{str}}, CodePointAppender(expected16));
+        std::ranges::copy(UTFView{std::u32string_view{str}}, CodePointAppender(expected32));
+        EXPECT_EQ(utf32_to_8(str), expected8);
+        EXPECT_EQ(utf32_to_16(str), expected16);
+        EXPECT_EQ(utf32_to_32(str), expected32);
+    }
+}
+
+TEST(UtilityTests, test_UTFConvert_policies)
+{
+    using namespace utfcpp;
+    // \xfa and the truncated \xe6\x97 are invalid
+    std::u8string invalid8{u8"ab"};
+    invalid8.append({0xfa});
+    invalid8.append(u8"шн");
+    invalid8.append({0xe6, 0x97});
+
+    auto replaced = UTFConvert<ReplaceInvalid, char8_t, char16_t>(invalid8);
+    EXPECT_TRUE(replaced.str == utf8_to_16(invalid8));
+    EXPECT_EQ(replaced.consumed, invalid8.size());
+    EXPECT_TRUE(replaced.error_code == UTF_ERROR::OK);
+
+    auto skipped = UTFConvert<SkipInvalid, char8_t, char16_t>(invalid8);
+    EXPECT_TRUE(skipped.str == u"abшн");
+    EXPECT_EQ(skipped.consumed, invalid8.size());
+    EXPECT_TRUE(skipped.error_code == UTF_ERROR::OK);
+
+    auto stopped = UTFConvert<StopOnInvalid, char8_t, char32_t>(invalid8);
+    EXPECT_TRUE(stopped.str == U"ab");
+    EXPECT_EQ(stopped.consumed, 2);
+    EXPECT_TRUE(stopped.error_code == UTF_ERROR::INVALID_LEAD);
+
+    bool thrown = false;
+    try { UTFConvert<ThrowOnInvalid, char8_t, char32_t>(invalid8); } catch (const DecodingError&) { thrown = true; }
+    EXPECT_TRUE(thrown);
+
+    std::u16string invalid16{{0xdc07, 0x0061, 0xd800, 0xd800, 0xdc00, 0xd800}};
+    EXPECT_TRUE((UTFConvert<SkipInvalid, char16_t, char8_t>(invalid16).str == u8"a𐀀"));
+    EXPECT_EQ((UTFConvert<StopOnInvalid, char16_t, char8_t>(invalid16).consumed), 0);
+    std::u32string invalid32{{0x61, 0x0011ffff, 0x62}};
+    EXPECT_TRUE((UTFConvert<SkipInvalid, char32_t, char16_t>(invalid32).str == u"ab"));
+    EXPECT_TRUE((UTFConvert<StopOnInvalid, char32_t, char16_t>(invalid32).error_code == UTF_ERROR::INVALID_CODE_POINT));
+
+    // Valid input converts the same under every policy
+    std::u8string_view valid{u8"abcdxyzшницла水手𐌀"};
+    EXPECT_TRUE((UTFConvert<ThrowOnInvalid, char8_t, char16_t>(valid).str == u"abcdxyzшницла水手𐌀"));
+    EXPECT_TRUE((UTFConvert<StopOnInvalid, char8_t, char8_t>(valid).str == valid));
+    EXPECT_TRUE((UTFConvert<SkipInvalid, char8_t, char32_t>(valid).str == U"abcdxyzшницла水手𐌀"));
+
+    uint32_t seed = 2024;
+    for (int round = 0; round < 500; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        std::u16string expected{};
+        for (UTFInputIterator<char8_t> iter{str}; iter != UTFInputIterator<char8_t>::sentinel{}; ++iter) {
+            if (iter.DecodeError() == UTF_ERROR::OK) { CodePointAppender(expected) = *iter; }
+        }
+        EXPECT_TRUE((UTFConvert<SkipInvalid, char8_t, char16_t>(str).str == expected));
+        auto result = UTFConvert<StopOnInvalid, char8_t, char16_t>(str);
+        EXPECT_EQ(result.consumed, FindInvalid<char8_t>(str));
+        EXPECT_TRUE(result.str == utf8_to_16(str.substr(0, result.consumed)));
+    }
+}
+
+TEST(UtilityTests, test_allocator_aware_conversions)
+{
+    using namespace utfcpp;
+    // The arena cannot grow, so every allocation must come from buffer
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer), std::pmr::null_memory_resource()};
+    auto in_arena = [&buffer](const void* p) {
+        return static_cast<const std::byte*>(p) >= buffer && static_cast<const std::byte*>(p) < buffer + sizeof(buffer);
+    };
+
+    std::u8string_view text{u8"abcdxyzшницла水手𐌀 abcdxyzшницла水手𐌀"};
+    std::pmr::u16string utf16 = pmr::utf8_to_16(text, &arena);
+    EXPECT_TRUE(std::u16string_view{utf16} == utf8_to_16(text));
+    EXPECT_TRUE(in_arena(utf16.data()));
+    std::pmr::u32string utf32 = pmr::utf16_to_32<UTFLeanIterator>(utf16, &arena);
+    EXPECT_TRUE(std::u32string_view{utf32} == utf8_to_32(text));
+    EXPECT_TRUE(in_arena(utf32.data()));
+    std::pmr::u8string utf8 = pmr::utf32_to_8(utf32, &arena);
+    EXPECT_TRUE(std::u8string_view{utf8} == text);
+    EXPECT_TRUE(in_arena(utf8.data()));
+
+    auto skipped = UTFConvert<SkipInvalid, char8_t, char32_t>(text, std::pmr::polymorphic_allocator<char32_t>{&arena});
+    EXPECT_TRUE(std::u32string_view{skipped.str} == utf32);
+    EXPECT_TRUE(in_arena(skipped.str.data()));
+
+    std::pmr::u16string appended{&arena};
+    std::ranges::copy(UTFView{text}, CodePointAppender(appended));
+    EXPECT_TRUE(appended == utf16);
+    EXPECT_TRUE(in_arena(appended.data()));
+}
+
+TEST(UtilityTests, test_UTFConvertAppend)
+{
+    using namespace utfcpp;
+    uint32_t seed = 3131;
+    for (int round = 0; round < 200; ++round) {
+        std::u8string str = RandomUTF8(seed, round % 10 ? 60 : 400);
+        const std::u16string expected = u"prefix" + utf8_to_16(str);
+
+        std::u16string string_sink{u"prefix"};
+        TranscodeResult result = UTFConvertAppend<char8_t, char16_t>(str, string_sink);
+        EXPECT_TRUE(string_sink == expected);
+        EXPECT_EQ(result.consumed, str.size());
+        EXPECT_EQ(result.produced, expected.size() - 6);
+
+        std::vector<char16_t> vector_sink{u'p', u'r', u'e', u'f', u'i', u'x'};
+        UTFConvertAppend<char8_t, char16_t>(str, vector_sink);
+        EXPECT_TRUE(std::ranges::equal(vector_sink, expected));
+
+        std::deque<char16_t> deque_sink{u'p', u'r', u'e', u'f', u'i', u'x'};
+        result = UTFConvertAppend<char8_t, char16_t>(str, deque_sink);
+        EXPECT_TRUE(std::ranges::equal(deque_sink, expected));
+        EXPECT_EQ(result.produced, expected.size() - 6);
+
+        // A full SpanSink holds a prefix made of whole code points
+        std::u16string buffer(expected.size() / 2 + 1, u'\0');
+        SpanSink<char16_t> span_sink{std::span{buffer}};
+        result = UTFConvertAppend<char8_t, char16_t>(str, span_sink);
+        EXPECT_EQ(span_sink.Size(), result.produced);
+        EXPECT_TRUE(std::u16string_view(buffer.data(), result.produced) == utf8_to_16(std::u8string_view{str}.substr(0, result.consumed)));
+        EXPECT_EQ(span_sink.Overflow(), result.error_code == UTF_ERROR::NOT_ENOUGH_ROOM);
+        EXPECT_EQ(span_sink.Overflow(), result.consumed < str.size());
+    }
+}
+
+TEST(UtilityTests, test_UTFConvertInto)
+{
+    using namespace utfcpp;
+    char8_t buffer8[8]{};
+    TranscodeResult result = UTFConvertInto<char32_t, char8_t>(U"ab水𐌀", std::span{buffer8});
+    EXPECT_EQ(result.consumed, size_t{3});
+    EXPECT_EQ(result.produced, size_t{5});
+    EXPECT_EQ(result.error_code, UTF_ERROR::NOT_ENOUGH_ROOM);
+    EXPECT_TRUE(std::u8string_view(buffer8, 5) == u8"ab水");
+    result = UTFConvertInto<char32_t, char8_t>(U"ab水", std::span{buffer8});
+    EXPECT_EQ(result.consumed, size_t{3});
+    EXPECT_EQ(result.error_code, UTF_ERROR::OK);
+    EXPECT_EQ((UTFConvertInto<char8_t, char8_t>(u8"a", std::span<char8_t>{}).error_code), UTF_ERROR::NOT_ENOUGH_ROOM);
+
+    std::u8string invalid8{u8"ab"};
+    invalid8.append({0xfa});
+    invalid8.append(u8"шн");
+    char16_t buffer16[8]{};
+    result = UTFConvertInto<StopOnInvalid, char8_t, char16_t>(invalid8, std::span{buffer16});
+    EXPECT_EQ(result.consumed, size_t{2});
+    EXPECT_EQ(result.produced, size_t{2});
+    EXPECT_EQ(result.error_code, UTF_ERROR::INVALID_LEAD);
+    result = UTFConvertInto<SkipInvalid, char8_t, char16_t>(invalid8, std::span{buffer16});
+    EXPECT_EQ(result.consumed, invalid8.size());
+    EXPECT_TRUE(std::u16string_view(buffer16, result.produced) == u"abшн");
+    bool thrown = false;
+    try { UTFConvertInto<ThrowOnInvalid, char8_t, char16_t>(invalid8, std::span{buffer16}); } catch (const DecodingError&) { thrown = true; }
+    EXPECT_TRUE(thrown);
+
+    // Buffers of any size, refilled until src is used up, give the same output as converting it whole
+    auto fill = [](auto policy, std::u8string_view src, size_t buffer_size) {
+        std::u16string buffer(buffer_size, u'\0');
+        std::u16string output{};
+        TranscodeResult result{};
+        while (!src.empty()) {
+            result = UTFConvertInto<decltype(policy), char8_t, char16_t>(src, std::span{buffer});
+            output.append(buffer, 0, result.produced);
+            src.remove_prefix(result.consumed);
+            if (result.error_code != UTF_ERROR::NOT_ENOUGH_ROOM) { break; }
+            // Stopped early only if the next code point does not fit
+            EXPECT_TRUE(result.produced + detail::EncodedLengthOne<char16_t>(detail::DecodeOne(src).code_point) > buffer_size);
+        }
+        return std::tuple{output, src.size(), result.error_code};
+    };
+    uint32_t seed = 8080;
+    for (int round = 0; round < 300; ++round) {
+        std::u8string str = RandomUTF8(seed, 60);
+        for (size_t buffer_size : {2, 5, 64}) {
+            EXPECT_TRUE(std::get<0>(fill(ReplaceInvalid{}, str, buffer_size)) == utf8_to_16(str));
+            EXPECT_TRUE(std::get<0>(fill(SkipInvalid{}, str, buffer_size)) == (UTFConvert<SkipInvalid, char8_t, char16_t>(str).str));
+            const auto [output, left, error_code] = fill(StopOnInvalid{}, str, buffer_size);
+            const auto stopped = UTFConvert<StopOnInvalid, char8_t, char16_t>(str);
+            EXPECT_TRUE(output == stopped.str);
+            EXPECT_EQ(str.size() - left, stopped.consumed);
+            EXPECT_EQ(error_code, stopped.error_code);
+        }
+    }
+}
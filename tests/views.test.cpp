@@ -12,6 +12,10 @@
 //    See the License for the specific language governing permissions and
 //    limitations under the License.
 
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+
 #include "utfcpp/utfcpp.hpp"
 #include "ftest.h"
 
@@ -106,3 +110,25 @@ TEST(ViewTests, test_u8_view_dims)
     EXPECT_TRUE(ev2);
     EXPECT_EQ(ev2.size(), sv2.size());
 }
+
+TEST(ViewTests, test_bidirectional_view)
+{
+    using namespace utfcpp;
+    std::u8string_view sv8{u8"abcdxyzшницла水手𐌀"};
+    utf8_view<UTFBidirectionalIterator> v8{sv8};
+    static_assert(std::ranges::bidirectional_range<decltype(v8)>);
+    static_assert(std::ranges::common_range<decltype(v8)>);
+
+    // The last three code points, decoded from the end
+    std::u32string last{};
+    std::ranges::copy(v8 | std::views::reverse | std::views::take(3), std::back_inserter(last));
+    EXPECT_EQ(last, U"𐌀手水");
+    EXPECT_EQ(*std::ranges::prev(v8.end(), 4), U'а');
+    EXPECT_EQ(std::ranges::prev(v8.end(), 4).Data(), u8"а水手𐌀");
+
+    std::u32string reversed{};
+    std::ranges::copy(utf16_view<UTFBidirectionalIterator>{u"aш𐌀"} | std::views::reverse, std::back_inserter(reversed));
+    EXPECT_EQ(reversed, U"𐌀шa");
+
+    EXPECT_EQ((utf8_to_16<UTFBidirectionalIterator>(sv8)), u"abcdxyzшницла水手𐌀");
+}